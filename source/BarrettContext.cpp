@@ -0,0 +1,284 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				BarrettContext.cpp
+ *
+ * This file contains the implementation for the BarrettContext class.
+ *
+ * ****************************************************************************
+ */
+
+#include "BarrettContext.h"
+#include <algorithm>	//copy(), fill()
+
+/* Creates a context for reductions modulo "modulus". Throws an exception
+ * if "modulus" isn't positive. */
+BarrettContext::BarrettContext(const BigInt &modulus) :
+	modulus(modulus), k(modulus.Length())
+{
+	if (!modulus.IsPositive() || modulus.EqualsZero())
+		throw "Error BARRETT00: The modulus must be positive.";
+
+	BigInt remainder;
+	BigInt::divide(powerOfTen(2 * k), modulus, mu, remainder);
+	wrap = powerOfTen(k + 1);
+}
+
+/* Returns 10^n, a one followed by n zeroes. */
+BigInt BarrettContext::powerOfTen(unsigned long int n)
+{
+	BigInt power;
+	power.expandTo(n + 1);
+	std::fill(power.digits, power.digits + n, 0);
+	power.digits[n] = 1;
+	power.digitCount = n + 1;
+	return power;
+}
+
+/* Returns |number| mod 10^n, n > 0. */
+BigInt BarrettContext::truncate(const BigInt &number, unsigned long int n)
+{
+	BigInt result(number);
+	result.positive = true;
+	if (result.digitCount > n)
+	{
+		result.digitCount = n;
+		while (result.digitCount > 1 && !result.digits[result.digitCount - 1])
+			result.digitCount--;
+	}
+	return result;
+}
+
+/* Returns floor(|number| / 10^n). */
+BigInt BarrettContext::shiftDown(const BigInt &number, unsigned long int n)
+{
+	if (n >= number.digitCount)
+		return BigIntZero;
+	BigInt result(number);
+	std::copy(result.digits + n, result.digits + result.digitCount,
+			result.digits);
+	result.digitCount -= n;
+	result.positive = true;
+	return result;
+}
+
+/* number = |number| mod modulus. */
+void BarrettContext::Reduce(BigInt &number) const
+{
+	//the estimate is only good for numbers less than 10^(2k)
+	if (number.digitCount > 2 * k)
+	{
+		BigInt quotient;
+		BigInt::divide(number, modulus, quotient, number);
+		return;
+	}
+	number.positive = true;
+	if (BigInt::compareNumbers(	number.digits, number.digitCount,
+								modulus.digits, modulus.digitCount) == 2)
+		return;
+
+	//the estimate of the quotient is at most 3 too small (one more than 
+	//usual, since MulHigh() may be one too small)
+	const BigInt q(BigInt::MulHigh(shiftDown(number, k - 1), mu, k + 1));
+	
+	//so the remainder is less than 4n < 10^(k + 1), and only the lowest 
+	//k + 1 digits of q * n are needed
+	number = truncate(number, k + 1) - BigInt::MulLow(q, modulus, k + 1);
+	if (!number.positive)
+		number += wrap;
+	while (number >= modulus)
+		number -= modulus;
+}
+
+/* Returns the sliding window size for an exponent "bitCount" bits
+ * long. */
+unsigned long int BarrettContext::windowSize(unsigned long int bitCount)
+{
+	//longer exponents pay for a bigger table with fewer multiplications
+	return bitCount > 512 ? 5 : bitCount > 128 ? 4 : bitCount > 32 ? 3 :
+			bitCount > 8 ? 2 : 1;
+}
+
+/* Splits "bits" into windows of at most "w" bits, each beginning
+ * and ending with a one. window[i] is the value of the window whose
+ * lowest bit is i, or 0 if there is none. */
+void BarrettContext::findWindows(	const std::vector<bool> &bits,
+									unsigned long int w,
+									std::vector<unsigned long int> &window)
+{
+	for (long int i((long int) bits.size() - 1); i >= 0; )
+	{
+		if (!bits[i])
+		{
+			i--;
+			continue;
+		}
+		//the longest window of at most w bits ending with a one
+		long int low(i - (long int) w + 1 > 0 ? i - (long int) w + 1 : 0);
+		while (!bits[low])
+			low++;
+		unsigned long int value(0);
+		for (long int k(i); k >= low; k--)
+			value = (value << 1) | bits[k];
+		window[low] = value;
+		i = low - 1;
+	}
+}
+
+/* odd[i] = (base to the power of 2i + 1) mod modulus, for
+ * 0 <= i < 2^(w - 1). */
+void BarrettContext::oddPowers(	const BigInt &base, unsigned long int w,
+								std::vector<BigInt> &odd) const
+{
+	odd.assign(1, base);
+	Reduce(odd[0]);
+	if (w > 1)
+	{
+		const BigInt square(Multiply(odd[0], odd[0]));
+		for (unsigned long int i(1); i < (1UL << (w - 1)); i++)
+			odd.push_back(Multiply(odd[i - 1], square));
+	}
+}
+
+/* Returns (a * b) mod modulus. */
+BigInt BarrettContext::Multiply(const BigInt &a, const BigInt &b) const
+{
+	BigInt product(a * b);
+	Reduce(product);
+	return product;
+}
+
+/* Returns (base to the power of exponent) mod modulus. */
+BigInt BarrettContext::PowerMod(const BigInt &base,
+								const BigInt &exponent) const
+{
+	std::vector<BigInt> numbers(1, base);
+	PowerModBatch(numbers, exponent);
+	return numbers[0];
+}
+
+/* numbers[i] = (numbers[i] to the power of exponent) mod modulus, for
+ * every i. The exponent is split into sliding windows once for the whole
+ * batch, and every number is then raised using them: besides the
+ * squarings, that takes a multiplication per window of up to w bits
+ * instead of one per bit that is set. */
+void BarrettContext::PowerModBatch(	std::vector<BigInt> &numbers,
+									const BigInt &exponent) const
+{
+	if (!exponent.positive)
+		throw "Error BARRETT01: Negative exponent not supported.";
+
+	//the bases are reduced first, so that every product is less than
+	//10^(2k) and takes the fast path of Reduce()
+	for (unsigned long int j(0); j < numbers.size(); j++)
+		Reduce(numbers[j]);
+
+	//the usual public RSA exponent 65537 = 2^16 + 1 needs just 16
+	//squarings and a multiplication
+	static const BigInt F4(65537UL);
+	if (exponent == F4)
+	{
+		for (unsigned long int j(0); j < numbers.size(); j++)
+		{
+			const BigInt base(numbers[j]);
+			for (int i(0); i < 16; i++)
+				numbers[j] = Multiply(numbers[j], numbers[j]);
+			numbers[j] = Multiply(numbers[j], base);
+		}
+		return;
+	}
+
+	//the windows of the exponent are the same for every number
+	std::vector<bool> bits;
+	BigInt::toBits(exponent, bits);
+	const unsigned long int w(windowSize(bits.size()));
+	std::vector<unsigned long int> window(bits.size(), 0);
+	findWindows(bits, w, window);
+
+	//only the table of odd powers is made for each number
+	std::vector<BigInt> odd;
+	for (unsigned long int j(0); j < numbers.size(); j++)
+	{
+		oddPowers(numbers[j], w, odd);
+		BigInt result(BigIntOne);
+		bool started(false);
+		for (long int i((long int) bits.size() - 1); i >= 0; i--)
+		{
+			if (started)
+				result = Multiply(result, result);
+			if (window[i])
+			{
+				const BigInt &power(odd[window[i] >> 1]);
+				result = started ? Multiply(result, power) : power;
+				started = true;
+			}
+		}
+		numbers[j] = result;
+	}
+}
+
+/* Returns the product of (bases[i] to the power of exponents[i]) mod
+ * modulus, for every i. This is Straus' method with sliding windows: all
+ * the powers are computed together, so the squarings are done only once
+ * for the longest exponent, and each exponent adds a multiplication per
+ * window of up to w bits. */
+BigInt BarrettContext::MultiPowMod(	const std::vector<BigInt> &bases,
+									const std::vector<BigInt> &exponents) const
+{
+	if (bases.size() != exponents.size() || bases.empty())
+		throw "Error BARRETT02: Bases and exponents must come in pairs.";
+
+	std::vector<std::vector<bool> > bits(bases.size());
+	unsigned long int maxBits(0);
+	for (unsigned long int j(0); j < bases.size(); j++)
+	{
+		if (!exponents[j].positive)
+			throw "Error BARRETT01: Negative exponent not supported.";
+		BigInt::toBits(exponents[j], bits[j]);
+		if (bits[j].size() > maxBits)
+			maxBits = bits[j].size();
+	}
+
+	//odd[j][i] = bases[j]^(2i + 1), and window[j][i] is the odd value of
+	//the window of exponents[j] ending at bit i, or 0 if there is none
+	const unsigned long int w(windowSize(maxBits));
+	std::vector<std::vector<BigInt> > odd(bases.size());
+	std::vector<std::vector<unsigned long int> > window(bases.size(),
+			std::vector<unsigned long int>(maxBits, 0));
+	for (unsigned long int j(0); j < bases.size(); j++)
+	{
+		oddPowers(bases[j], w, odd[j]);
+		findWindows(bits[j], w, window[j]);
+	}
+
+	//one shared chain of squarings, from the most significant bit
+	BigInt result(BigIntOne);
+	bool started(false);
+	for (long int i((long int) maxBits - 1); i >= 0; i--)
+	{
+		if (started)
+			result = Multiply(result, result);
+		for (unsigned long int j(0); j < bases.size(); j++)
+			if (window[j][i])
+			{
+				const BigInt &power(odd[j][window[j][i] >> 1]);
+				result = started ? Multiply(result, power) : power;
+				started = true;
+			}
+	}
+	return result;
+}
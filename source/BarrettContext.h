@@ -0,0 +1,115 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				BarrettContext.h
+ *
+ * Barrett reduction modulo a fixed modulus.
+ *
+ * Reducing a number modulo n with BigInt's operator% performs a long
+ * division. When many numbers are reduced modulo the same n, as in modular
+ * exponentiation, a BarrettContext can do it faster. It computes
+ *
+ * 			mu = floor(10^(2k) / n)
+ *
+ * once, where k is the number of digits of n. After that, a number x with
+ * at most 2k digits is reduced using two multiplications and digit shifts:
+ *
+ * 			q = floor(floor(x / 10^(k - 1)) * mu / 10^(k + 1))
+ * 			r = x - q * n
+ *
+ * followed by at most three subtractions of n. Only the high half of the
+ * first product and the low k + 1 digits of the second one are needed,
+ * so they are computed with BigInt::MulHigh() and BigInt::MulLow(), each
+ * about half of a multiplication. The results are ordinary
+ * numbers, so unlike Montgomery reduction, no conversion is needed before
+ * or after.
+ *
+ * BarrettContext supports:
+ *
+ * 	- reduction (Reduce())
+ * 	- modular multiplication (Multiply())
+ * 	- modular exponentiation (PowerMod(), PowerModBatch())
+ * 	- products of modular powers (MultiPowMod())
+ *
+ * BigInt::GetPowerMod(), SetPowerMod() and PowerModBatch() use a
+ * BarrettContext.
+ *
+ * ****************************************************************************
+ */
+
+#ifndef BARRETTCONTEXT_H_
+#define BARRETTCONTEXT_H_
+
+#include "BigInt.h"
+#include <vector>	//vector
+
+class BarrettContext
+{
+	private:
+		/* The modulus n. */
+		BigInt modulus;
+		/* floor(10^(2k) / n). */
+		BigInt mu;
+		/* The number of digits of the modulus. */
+		unsigned long int k;
+		/* 10^(k + 1). */
+		BigInt wrap;
+		/* Returns 10^n, a one followed by n zeroes. */
+		static BigInt powerOfTen(unsigned long int n);
+		/* Returns |number| mod 10^n, n > 0. */
+		static BigInt truncate(const BigInt &number, unsigned long int n);
+		/* Returns floor(|number| / 10^n). */
+		static BigInt shiftDown(const BigInt &number, unsigned long int n);
+		/* Returns the sliding window size for an exponent "bitCount" bits
+		 * long. */
+		static unsigned long int windowSize(unsigned long int bitCount);
+		/* Splits "bits" into windows of at most "w" bits, each beginning
+		 * and ending with a one. window[i] is the value of the window whose
+		 * lowest bit is i, or 0 if there is none. */
+		static void findWindows(const std::vector<bool> &bits,
+								unsigned long int w,
+								std::vector<unsigned long int> &window);
+		/* odd[i] = (base to the power of 2i + 1) mod modulus, for
+		 * 0 <= i < 2^(w - 1). */
+		void oddPowers(	const BigInt &base, unsigned long int w,
+						std::vector<BigInt> &odd) const;
+	public:
+		/* Creates a context for reductions modulo "modulus". Throws an
+		 * exception if "modulus" isn't positive. */
+		explicit BarrettContext(const BigInt &modulus);
+		/* Returns the modulus. */
+		const BigInt &GetModulus() const
+		{
+			return modulus;
+		}
+		/* number = |number| mod modulus. */
+		void Reduce(BigInt &number) const;
+		/* Returns (a * b) mod modulus. */
+		BigInt Multiply(const BigInt &a, const BigInt &b) const;
+		/* Returns (base to the power of exponent) mod modulus. */
+		BigInt PowerMod(const BigInt &base, const BigInt &exponent) const;
+		/* numbers[i] = (numbers[i] to the power of exponent) mod modulus,
+		 * for every i. */
+		void PowerModBatch(	std::vector<BigInt> &numbers,
+							const BigInt &exponent) const;
+		/* Returns the product of (bases[i] to the power of exponents[i])
+		 * mod modulus, for every i. */
+		BigInt MultiPowMod(	const std::vector<BigInt> &bases,
+							const std::vector<BigInt> &exponents) const;
+};
+
+#endif /*BARRETTCONTEXT_H_*/
@@ -45,10 +45,15 @@
 //#define KARATSUBA
 
 #include "BigInt.h"
-#include <cstring>	//strlen()
+#include "BarrettContext.h"	//BarrettContext
+#include "ThreadPool.h"	//ThreadPool
+#include <cstring>	//strlen(), memcpy()
 #include <climits>	//ULONG_MAX
 #include <vector>	//vector<bool>
 #include <string>	//operator std::string()
+#include <deque>	//deque
+#include <mutex>	//mutex
+#include <functional>	//function
 #include <algorithm>    //reverse_copy(), copy(), copy_backward(), 
 						//fill(), fill_n()
 
@@ -60,9 +65,10 @@ const double BigInt::FACTOR = 1.6;
 
 //A BigInt number with the value of ULONG_MAX
 static const BigInt ULongMax(ULONG_MAX);
-//A BigInt number with the value of sqrt(ULONG_MAX)
+//A BigInt number with the value of sqrt(ULONG_MAX), rounded down; 
+//sqrt() of a double rounds it up to a power of 2, whose square overflows
 static const BigInt SqrtULongMax
-		(static_cast<unsigned long int>(sqrt(static_cast<double>(ULONG_MAX))));
+		((1UL << (sizeof(unsigned long int) * CHAR_BIT / 2)) - 1);
 
 /* Transforms the number from unsigned long int to unsigned char[]
  * and pads the result with zeroes. Returns the number of digits. */
@@ -79,23 +85,46 @@ unsigned long int BigInt::int2uchar(unsigned long int number,
 		number /= 10;
 	} while (number > 0L);
 	
-	std::fill_n(digits + i, padding, 0);
+	if (padding > (unsigned long int) i)
+		std::fill_n(digits + i, padding - i, 0);
 	return i;
 }
 
-/* Converts ASCII digits to equivalent unsigned char numeric values. */
+/* Converts ASCII digits to equivalent unsigned char numeric values. 
+ * Eight digits are converted at a time, as one 64-bit word. No byte 
+ * borrows from its neighbour, since every byte is at least '0'. */
 void BigInt::char2uchar(unsigned char *array, 
 						unsigned long int length)
 {
-	for (unsigned long int i(0L); i < length; i++)
+	unsigned long int i(0L);
+	for (; i + 8 <= length; i += 8)
+	{
+		std::uint64_t word;
+		memcpy(&word, array + i, 8);
+		word -= 0x3030303030303030ULL;
+		memcpy(array + i, &word, 8);
+	}
+	for (; i < length; i++)
 		array[i] -= '0';
 }
 
-/* Check if all ASCII values are digits '0' to '9'. */
+/* Check if all ASCII values are digits '0' to '9'. Eight characters are 
+ * checked at a time: a byte is a digit if its high half is 3, and the 
+ * high half is still 3 after adding 6 to the byte. */
 bool BigInt::allCharsAreDigits(	const char *array, 
 								unsigned long int length)
 {
-	for (unsigned long int i(0L); i < length; i++)
+	unsigned long int i(0L);
+	for (; i + 8 <= length; i += 8)
+	{
+		std::uint64_t word;
+		memcpy(&word, array + i, 8);
+		if (((word & 0xF0F0F0F0F0F0F0F0ULL) | 
+			(((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) 
+			!= 0x3333333333333333ULL)
+			return false;
+	}
+	for (; i < length; i++)
 		if (array[i] < '0' || array[i] > '9')
 			return false;
 			
@@ -109,12 +138,16 @@ int BigInt::compareNumbers(	unsigned char *a, unsigned long int na,
 		                    unsigned char *b, unsigned long int nb,
 		                    bool aPositive, bool bPositive)
 {
-	if (na < nb || !aPositive && bPositive)
+	if (!aPositive && bPositive)
 	//a < b
 	    return 2;
-	else if (na > nb || aPositive && !bPositive)
+	else if (aPositive && !bPositive)
 	//a > b
 	    return 1;
+	
+	//the signs are the same, the longer number is bigger by absolute value
+	if (na != nb)
+		return (na > nb) == aPositive ? 1 : 2;
 
 	//check the digits one by one starting from the most significant one
 	for (long int i = na - 1; i >= 0L; i--)
@@ -137,10 +170,35 @@ int BigInt::compareNumbers(	unsigned char *a, unsigned long int na,
 	return 0;
 }
 
+/* The length of the factors, in digits, from which karatsubaMultiply() 
+ * computes its three products in parallel. */
+static const unsigned long int ParallelDigits(4000);
+
+/* Returns the number of top recursion levels of a product of "length" 
+ * digits or limbs that should run their partial products in parallel: 
+ * enough for about two tasks per thread of the default pool, or none if 
+ * "length" is less than "threshold". Each task that waits for its own 
+ * subtasks runs queued tasks meanwhile, so the levels are kept few to 
+ * keep the threads' stacks short. */
+static unsigned long int parallelLevels(unsigned long int length, 
+										unsigned long int threshold)
+{
+	if (length < threshold)
+		return 0;
+	const unsigned long int threads(ThreadPool::GetDefault().GetThreadCount());
+	unsigned long int levels(0);
+	for (unsigned long int tasks(1); threads > 1 && tasks < 2 * threads; 
+			tasks *= 3)
+		levels++;
+	return levels;
+}
+
 /* Multiplies two unsigned char[] using the Divide and Conquer 
- * a.k.a. Karatsuba algorithm .*/
+ * a.k.a. Karatsuba algorithm. The three products of the top "levels" 
+ * recursion levels are computed in parallel. */
 void BigInt::karatsubaMultiply(	unsigned char *a, unsigned char *b,
-								unsigned long int n, unsigned char *buf1)
+								unsigned long int n, unsigned char *buf1, 
+								unsigned long int levels)
 {
 	//if *a <= SqrtULongMax && *b <= SqrtULongMax, 
 	//the CPU can do the multiplication
@@ -162,9 +220,37 @@ void BigInt::karatsubaMultiply(	unsigned char *a, unsigned char *b,
 	
 	BigInt::add(a + nl, nh, a, nl, buf1, nt);
 	BigInt::add(b + nl, nh, b, nl, buf1 + nt, nt);
-	BigInt::karatsubaMultiply(a + nl, b + nl, nh, t1);	//p1
-	BigInt::karatsubaMultiply(a, b, nl, t1 + (nh << 1));		//p2
-	BigInt::karatsubaMultiply(buf1, buf1 + nt, nt, t1 + (n << 1));//p3
+	if (levels > 0 && n >= ParallelDigits)
+	{
+		//one after another, p1 and p2 would use the space of the next 
+		//products as scratch space, so in parallel they get their own
+		std::vector<unsigned char> buffer1(9 * nh), buffer2(9 * nl);
+		std::vector<std::function<void()> > tasks;
+		tasks.push_back([&]() 
+		{
+			BigInt::karatsubaMultiply(a + nl, b + nl, nh, &buffer1[0], 
+					levels - 1);
+		});
+		tasks.push_back([&]() 
+		{
+			BigInt::karatsubaMultiply(a, b, nl, &buffer2[0], levels - 1);
+		});
+		tasks.push_back([&]() 
+		{
+			BigInt::karatsubaMultiply(buf1, buf1 + nt, nt, t1 + (n << 1), 
+					levels - 1);
+		});
+		ThreadPool::GetDefault().Run(tasks);
+		std::copy(buffer1.begin(), buffer1.begin() + (nh << 1), t1);
+		std::copy(buffer2.begin(), buffer2.begin() + (nl << 1), 
+				t1 + (nh << 1));
+	}
+	else
+	{
+		BigInt::karatsubaMultiply(a + nl, b + nl, nh, t1);	//p1
+		BigInt::karatsubaMultiply(a, b, nl, t1 + (nh << 1));		//p2
+		BigInt::karatsubaMultiply(buf1, buf1 + nt, nt, t1 + (n << 1));//p3
+	}
 	
 	//for leftshifting p3 and p1
 	unsigned long int power(n);
@@ -202,6 +288,52 @@ void BigInt::karatsubaMultiply(	unsigned char *a, unsigned char *b,
 	}
 }
 
+/* Multiplies unsigned char[] "a" and "b" using the Karatsuba algorithm, 
+ * without padding the shorter one to the length of the longer one. The 
+ * longer one is cut into blocks as long as the shorter one, and the last, 
+ * shorter block is multiplied the same way with the roles swapped. 
+ * "result" gets na + nb digits. */
+void BigInt::blockMultiply(	unsigned char *a, unsigned long int na,
+							unsigned char *b, unsigned long int nb,
+							unsigned char *result)
+{
+	if (na < nb)
+	{
+		std::swap(a, b);
+		std::swap(na, nb);
+	}
+	std::fill_n(result, na + nb, 0);
+	
+	//scratch space for Karatsuba, the first 2 * nb digits get the product
+	std::vector<unsigned char> buffer(9 * nb);
+	unsigned long int offset(0);
+	for (; offset < na; offset += nb)
+	{
+		unsigned long int blockLength(std::min(nb, na - offset));
+		if (blockLength == nb)
+			BigInt::karatsubaMultiply(a + offset, b, nb, &buffer[0], 
+					parallelLevels(nb, ParallelDigits));
+		else
+			BigInt::blockMultiply(b, nb, a + offset, blockLength, &buffer[0]);
+		
+		//result += product * 10^offset
+		unsigned char carry(0);
+		unsigned long int i(0);
+		for (; i < nb + blockLength; i++)
+		{
+			unsigned char sum(result[offset + i] + buffer[i] + carry);
+			carry = sum / 10;
+			result[offset + i] = sum % 10;
+		}
+		for (i += offset; carry; i++)
+		{
+			unsigned char sum(result[i] + carry);
+			carry = sum / 10;
+			result[i] = sum % 10;
+		}
+	}
+}
+
 /* Multiplies two unsigned char[] the long way. */
 void BigInt::longMultiply(	unsigned char *a, unsigned long int na,
 							unsigned char *b, unsigned long int nb,
@@ -272,67 +404,688 @@ void BigInt::quickSub(	unsigned char *a, unsigned char *b,
 			*a = 9;
 }
 
-/* Divides two BigInt numbers by the formula 
- * dividend = divisor * quotient + remainder*/
-void BigInt::divide(const BigInt &dividend, const BigInt &divisor, 
-					BigInt &quotient, BigInt &remainder)
+/* Numbers used for radix conversion: 32-bit limbs in base 2^32 or 10^9, 
+ * least significant limb first. */
+typedef std::vector<std::uint32_t> Words;
+/* The radix of binary limbs. */
+static const std::uint64_t BinaryRadix(1ULL << 32);
+/* The radix of decimal limbs, nine digits each. */
+static const std::uint64_t DecimalRadix(1000000000ULL);
+
+/* Removes the leading zero limbs. */
+static void trimWords(Words &a)
+{
+	while (!a.empty() && a.back() == 0)
+		a.pop_back();
+}
+
+/* a += b * Radix^offset */
+template <std::uint64_t Radix>
+static void addWords(Words &a, const std::uint32_t *b, unsigned long int nb, 
+					unsigned long int offset = 0)
+{
+	if (a.size() < offset + nb)
+		a.resize(offset + nb, 0);
+	std::uint64_t carry(0);
+	unsigned long int i(0);
+	for (; i < nb; i++)
+	{
+		carry += (std::uint64_t) a[offset + i] + b[i];
+		a[offset + i] = (std::uint32_t) (carry % Radix);
+		carry /= Radix;
+	}
+	for (i += offset; carry; i++)
+	{
+		if (i == a.size())
+			a.push_back(0);
+		carry += a[i];
+		a[i] = (std::uint32_t) (carry % Radix);
+		carry /= Radix;
+	}
+}
+
+/* a -= b, where a >= b */
+template <std::uint64_t Radix>
+static void subtractWords(Words &a, const Words &b)
+{
+	bool borrow(false);
+	for (unsigned long int i(0); i < a.size() && (i < b.size() || borrow); i++)
+	{
+		const std::uint64_t subtrahend((i < b.size() ? b[i] : 0) + borrow);
+		borrow = a[i] < subtrahend;
+		a[i] = (std::uint32_t) (a[i] + (borrow ? Radix : 0) - subtrahend);
+	}
+}
+
+/* The length of the longer factor, in limbs, from which multiplyWords() 
+ * computes its partial products in parallel. */
+static const unsigned long int ParallelWords(2000);
+
+/* Tells multiplyWords() to choose the number of parallel levels itself. */
+static const unsigned long int AutoLevels(ULONG_MAX);
+
+/* Runs "first" and "second" on the default thread pool if "parallel" is 
+ * true, one after another otherwise. */
+template <typename First, typename Second>
+static void runTasks(bool parallel, const First &first, const Second &second)
+{
+	if (!parallel)
+	{
+		first();
+		second();
+		return;
+	}
+	std::vector<std::function<void()> > tasks;
+	tasks.push_back(first);
+	tasks.push_back(second);
+	ThreadPool::GetDefault().Run(tasks);
+}
+
+/* Runs "first", "second" and "third" on the default thread pool if 
+ * "parallel" is true, one after another otherwise. */
+template <typename First, typename Second, typename Third>
+static void runTasks(	bool parallel, const First &first, const Second &second, 
+						const Third &third)
+{
+	if (!parallel)
+	{
+		first();
+		second();
+		third();
+		return;
+	}
+	std::vector<std::function<void()> > tasks;
+	tasks.push_back(first);
+	tasks.push_back(second);
+	tasks.push_back(third);
+	ThreadPool::GetDefault().Run(tasks);
+}
+
+/* result = a * b, using the Karatsuba algorithm for long numbers. The 
+ * partial products of the top "levels" recursion levels are computed in 
+ * parallel. */
+template <std::uint64_t Radix>
+static void multiplyWords(	const std::uint32_t *a, unsigned long int na, 
+							const std::uint32_t *b, unsigned long int nb, 
+							Words &result, 
+							unsigned long int levels = AutoLevels)
 {
-	BigInt Z1, R, X(dividend.Abs());
-	/* Make sure quotient and remainder are zero. 
-	 * The lack of this assignment introduces a bug if the actual parameters 
-	 * are not zero when calling this function. */
-	quotient = BigIntZero;
-	remainder = BigIntZero;
+	result.assign(na + nb, 0);
+	if (na == 0 || nb == 0)
+		return;
+	if (na < nb)
+	{
+		std::swap(a, b);
+		std::swap(na, nb);
+	}
 	
-	// while |X| >= |divisor|
-	while (BigInt::compareNumbers(	X.digits, X.digitCount, 
-									divisor.digits, divisor.digitCount, 
-									true, true) != 2)	
+	//short numbers are multiplied the long way; a limb product plus two 
+	//limbs always fits into 64 bits
+	if (nb < 32)
 	{
-		unsigned long int O(X.digitCount - divisor.digitCount);
-		if (O <= ULongMax.digitCount - 2)
+		for (unsigned long int i(0); i < nb; i++)
 		{
-			unsigned long int i;
-			if (X.digitCount > ULongMax.digitCount - 1)
-				i = ULongMax.digitCount - 1;
-			else
-				i = X.digitCount;
-			unsigned long int j(i - O);
-			Z1 = 	toInt(X.digits + X.digitCount - i, i) / 
-					toInt(divisor.digits + divisor.digitCount - j, j);
+			std::uint64_t carry(0);
+			for (unsigned long int j(0); j < na; j++)
+			{
+				carry += (std::uint64_t) a[j] * b[i] + result[i + j];
+				result[i + j] = (std::uint32_t) (carry % Radix);
+				carry /= Radix;
+			}
+			result[i + na] = (std::uint32_t) carry;
 		}
-		else
+		return;
+	}
+	
+	const unsigned long int half(na / 2);
+	if (levels == AutoLevels)
+		levels = parallelLevels(na, ParallelWords);
+	const bool parallel(levels > 0 && na >= ParallelWords);
+	const unsigned long int next(parallel ? levels - 1 : 0);
+	Words product, z0, z2;
+	
+	//a much shorter b is multiplied with the halves of a separately
+	if (nb <= half)
+	{
+		runTasks(parallel, [&]() 
+		{
+			multiplyWords<Radix>(a, half, b, nb, z0, next);
+		}, [&]() 
+		{
+			multiplyWords<Radix>(a + half, na - half, b, nb, z2, next);
+		});
+		addWords<Radix>(result, &z0[0], z0.size());
+		addWords<Radix>(result, &z2[0], z2.size(), half);
+		result.resize(na + nb);
+		return;
+	}
+	
+	//a * b = z2 * Radix^(2 * half) + z1 * Radix^half + z0, where
+	//z1 = (a0 + a1) * (b0 + b1) - z2 - z0
+	Words sumA(a, a + half), sumB(b, b + half);
+	addWords<Radix>(sumA, a + half, na - half);
+	addWords<Radix>(sumB, b + half, nb - half);
+	runTasks(parallel, [&]() 
+	{
+		multiplyWords<Radix>(a, half, b, half, z0, next);
+	}, [&]() 
+	{
+		multiplyWords<Radix>(a + half, na - half, b + half, nb - half, z2, 
+				next);
+	}, [&]() 
+	{
+		multiplyWords<Radix>(&sumA[0], sumA.size(), &sumB[0], sumB.size(), 
+				product, next);
+	});
+	subtractWords<Radix>(product, z0);
+	subtractWords<Radix>(product, z2);
+	trimWords(product);
+	addWords<Radix>(result, &z0[0], z0.size());
+	addWords<Radix>(result, product.empty() ? 0 : &product[0], 
+			product.size(), half);
+	addWords<Radix>(result, &z2[0], z2.size(), 2 * half);
+	result.resize(na + nb);
+}
+
+/* Returns the "i"th power of "base" squared over and over, that is 
+ * base^(2^i), in "Radix". The powers are computed once and kept for later 
+ * conversions. The lock is not held while squaring: a long square runs on 
+ * the thread pool, and a waiting thread may run a queued task that needs 
+ * the powers too. */
+template <std::uint64_t Radix>
+static const Words &squaredPower(std::uint64_t base, unsigned long int i)
+{
+	static std::deque<Words> powers;
+	static std::mutex mutex;
+	std::unique_lock<std::mutex> lock(mutex);
+	if (powers.empty())
+	{
+		powers.push_back(Words());
+		for (; base; base /= Radix)
+			powers.back().push_back((std::uint32_t) (base % Radix));
+	}
+	while (powers.size() <= i)
+	{
+		const Words last(powers.back());
+		const unsigned long int count(powers.size());
+		lock.unlock();
+		Words square;
+		multiplyWords<Radix>(	&last[0], last.size(), &last[0], last.size(), 
+								square);
+		trimWords(square);
+		lock.lock();
+		//another thread may have added this power meanwhile
+		if (powers.size() == count)
+			powers.push_back(square);
+	}
+	//references to deque elements stay valid when more are added
+	return powers[i];
+}
+
+/* The number of decimal digits that always fit into 64 bits. */
+static const unsigned long int LeafDigits(19);
+
+/* Returns the value of 8 decimal digits, least significant first. The digits 
+ * are packed into one 64-bit word and combined in pairs, all pairs at once: 
+ * first into 2-digit values, then 4-digit values and then the result. */
+static std::uint64_t eightDigits(const unsigned char *digits)
+{
+	std::uint64_t word(0);
+	for (int i(7); i >= 0; i--)
+		word = (word << 8) | digits[i];
+	word = (word & 0x00FF00FF00FF00FFULL) + 
+			((word >> 8) & 0x00FF00FF00FF00FFULL) * 10;
+	word = (word & 0x0000FFFF0000FFFFULL) + 
+			((word >> 16) & 0x0000FFFF0000FFFFULL) * 100;
+	return (word & 0xFFFFFFFFULL) + (word >> 32) * 10000;
+}
+
+/* Stores the binary value of the "count" decimal digits at "digits" into 
+ * "words". The digits are split into a low part of 19 * 2^i digits and a 
+ * high part, and the value is high * 10^(19 * 2^i) + low. */
+void BigInt::decimalToWords(const unsigned char *digits, 
+							unsigned long int count, 
+							std::vector<std::uint32_t> &words)
+{
+	words.clear();
+	if (count <= LeafDigits)
+	{
+		std::uint64_t value(0);
+		unsigned long int i(count);
+		for (; i >= 8; i -= 8)
+			value = value * 100000000 + eightDigits(digits + i - 8);
+		while (i > 0)
+			value = value * 10 + digits[--i];
+		words.push_back((std::uint32_t) value);
+		words.push_back((std::uint32_t) (value >> 32));
+		trimWords(words);
+		return;
+	}
+	
+	unsigned long int i(0);
+	while ((LeafDigits << (i + 1)) < count)
+		i++;
+	const unsigned long int split(LeafDigits << i);
+	Words low, high;
+	decimalToWords(digits, split, low);
+	decimalToWords(digits + split, count - split, high);
+	const Words &power(squaredPower<BinaryRadix>(10000000000000000000ULL, i));
+	multiplyWords<BinaryRadix>(	high.empty() ? 0 : &high[0], high.size(), 
+								&power[0], power.size(), words);
+	addWords<BinaryRadix>(words, low.empty() ? 0 : &low[0], low.size());
+	trimWords(words);
+}
+
+/* Stores the value of the "count" binary words at "words" into "limbs" 
+ * of nine decimal digits. The words are split into a low part of 2^i 
+ * words and a high part, and the value is high * 2^(32 * 2^i) + low. */
+static void wordsToLimbs(	const std::uint32_t *words, unsigned long int count, 
+							Words &limbs)
+{
+	limbs.clear();
+	while (count > 0 && words[count - 1] == 0)
+		count--;
+	if (count <= 2)
+	{
+		std::uint64_t value(count > 0 ? words[0] : 0);
+		if (count > 1)
+			value |= (std::uint64_t) words[1] << 32;
+		for (; value; value /= DecimalRadix)
+			limbs.push_back((std::uint32_t) (value % DecimalRadix));
+		return;
+	}
+	
+	unsigned long int i(0);
+	while ((2UL << (i + 1)) < count)
+		i++;
+	const unsigned long int split(2UL << i);
+	Words low, high;
+	wordsToLimbs(words, split, low);
+	wordsToLimbs(words + split, count - split, high);
+	const Words &power(squaredPower<DecimalRadix>(BinaryRadix, i + 1));
+	multiplyWords<DecimalRadix>(&high[0], high.size(), 
+								&power[0], power.size(), limbs);
+	addWords<DecimalRadix>(limbs, low.empty() ? 0 : &low[0], low.size());
+	trimWords(limbs);
+}
+
+/* Returns the value of the "count" 32-bit words at "words". */
+BigInt BigInt::wordsToDecimal(	const std::uint32_t *words, 
+								unsigned long int count)
+{
+	Words limbs;
+	wordsToLimbs(words, count, limbs);
+	return fromLimbs(limbs);
+}
+
+/* Stores the absolute value into "limbs" of nine decimal digits, least 
+ * significant limb first. */
+void BigInt::toLimbs(std::vector<std::uint32_t> &limbs) const
+{
+	limbs.assign((digitCount + 8) / 9, 0);
+	for (unsigned long int i(digitCount); i > 0; i--)
+		limbs[(i - 1) / 9] = limbs[(i - 1) / 9] * 10 + digits[i - 1];
+}
+
+/* Returns the number stored in "limbs" of nine decimal digits, least 
+ * significant limb first. */
+BigInt BigInt::fromLimbs(const std::vector<std::uint32_t> &limbs)
+{
+	unsigned long int count(limbs.size());
+	while (count > 0 && limbs[count - 1] == 0)
+		count--;
+	if (count == 0)
+		return BigIntZero;
+	
+	BigInt result;
+	result.expandTo(9 * count + 1);
+	result.digitCount = 0;
+	for (unsigned long int i(0); i < count; i++)
+		for (std::uint32_t limb(limbs[i]), j(0); j < 9; j++, limb /= 10)
+			result.digits[result.digitCount++] = limb % 10;
+	while (result.digits[result.digitCount - 1] == 0)
+		result.digitCount--;
+	return result;
+}
+
+/* Stores the absolute value into 32-bit "words", least significant word 
+ * first, without leading zero words. */
+void BigInt::ToWords(std::vector<std::uint32_t> &words) const
+{
+	decimalToWords(digits, digitCount, words);
+}
+
+/* Returns the number stored in 32-bit "words", least significant word 
+ * first. */
+BigInt BigInt::FromWords(const std::vector<std::uint32_t> &words)
+{
+	return wordsToDecimal(words.empty() ? 0 : &words[0], words.size());
+}
+
+/* Stores the absolute value into "width" bytes at "bytes", in the given 
+ * byte order, padded with zero bytes. Throws an exception if the number 
+ * doesn't fit. */
+void BigInt::ToBytes(std::uint8_t *bytes, std::size_t width, 
+					Endian endian) const
+{
+	std::vector<std::uint32_t> words;
+	ToWords(words);
+	std::fill_n(bytes, width, 0);
+	for (std::size_t i(0); i < 4 * words.size(); i++)
+	{
+		const std::uint8_t byte(words[i / 4] >> (8 * (i % 4)));
+		if (i >= width)
 		{
-			unsigned long int i(ULongMax.digitCount - 1);
-			unsigned long int j;
-			if (divisor.digitCount > ULongMax.digitCount - 2)
-				j = ULongMax.digitCount - 2;
-			else
-				j = divisor.digitCount;
-			Z1 = 	toInt(X.digits + X.digitCount - i, i) / 
-					toInt(divisor.digits + divisor.digitCount - j, j);
-			Z1.shiftLeft(O - Z1.digitCount);		
+			if (byte)
+				throw "Error BIGINT18: Number too large for the given width.";
+			continue;
 		}
-		
-		predictZ1:
-		R = (Z1 * divisor).Abs();
+		bytes[endian == LITTLE ? i : width - 1 - i] = byte;
+	}
+}
+
+/* Returns the number stored in "count" bytes at "bytes", in the given 
+ * byte order. */
+BigInt BigInt::FromBytes(	const std::uint8_t *bytes, std::size_t count, 
+							Endian endian)
+{
+	std::vector<std::uint32_t> words((count + 3) / 4, 0);
+	for (std::size_t i(0); i < count; i++)
+		words[i / 4] |= (std::uint32_t) 
+				bytes[endian == LITTLE ? i : count - 1 - i] << (8 * (i % 4));
+	return FromWords(words);
+}
+
+/* Stores the binary representation of "number" into "bits", 
+ * least significant bit first. */
+void BigInt::toBits(const BigInt &number, std::vector<bool> &bits)
+{
+	std::vector<std::uint32_t> words;
+	number.ToWords(words);
+	bits.clear();
+	for (unsigned long int i(0); i < words.size(); i++)
+		for (int j(0); j < 32; j++)
+			bits.push_back((words[i] >> j) & 1);
+	while (!bits.empty() && !bits.back())
+		bits.pop_back();
+}
+
+/* Compares a and b, both without leading zero limbs. Returns 0 if a == b, 
+ * 1 if a > b, 2 if a < b. */
+static int compareWords(const Words &a, const Words &b)
+{
+	if (a.size() != b.size())
+		return a.size() > b.size() ? 1 : 2;
+	for (unsigned long int i(a.size()); i > 0; i--)
+		if (a[i - 1] != b[i - 1])
+			return a[i - 1] > b[i - 1] ? 1 : 2;
+	return 0;
+}
+
+/* a = a * 10^(9 * count) */
+static void shiftWords(Words &a, unsigned long int count)
+{
+	if (!a.empty())
+		a.insert(a.begin(), count, 0);
+}
+
+/* Divides decimal limbs "a" by "b", both without leading zero limbs, the 
+ * long way (Knuth's algorithm D). Each quotient limb is guessed from the 
+ * top limbs and is at most one too big after the divisor is scaled so 
+ * that its top limb is at least 10^9 / 2. */
+static void longDivideWords(const Words &a, const Words &b, 
+							Words &quotient, Words &remainder)
+{
+	const std::uint64_t B(DecimalRadix);
+	const unsigned long int n(a.size()), m(b.size());
+	if (compareWords(a, b) == 2)
+	{
+		quotient.clear();
+		remainder = a;
+		return;
+	}
+	if (m == 1)
+	{
+		quotient.assign(n, 0);
+		std::uint64_t rest(0);
+		for (unsigned long int i(n); i > 0; i--)
+		{
+			rest = rest * B + a[i - 1];
+			quotient[i - 1] = (std::uint32_t) (rest / b[0]);
+			rest %= b[0];
+		}
+		trimWords(quotient);
+		remainder.assign(1, (std::uint32_t) rest);
+		trimWords(remainder);
+		return;
+	}
+	
+	//scale both numbers, the quotient stays the same
+	const std::uint32_t factor((std::uint32_t) (B / (b[m - 1] + 1ULL)));
+	Words u, v;
+	multiplyWords<DecimalRadix>(&a[0], n, &factor, 1, u);
+	multiplyWords<DecimalRadix>(&b[0], m, &factor, 1, v);
+	v.resize(m);
+	u.resize(n + 1, 0);
 	
-		if (X >= R)
+	quotient.assign(n - m + 1, 0);
+	for (unsigned long int j(n - m + 1); j-- > 0; )
+	{
+		const std::uint64_t top((std::uint64_t) u[j + m] * B + u[j + m - 1]);
+		std::uint64_t guess(top / v[m - 1]), rest(top % v[m - 1]);
+		while (guess >= B || guess * v[m - 2] > rest * B + u[j + m - 2])
+		{
+			guess--;
+			rest += v[m - 1];
+			if (rest >= B)
+				break;
+		}
+		
+		//u -= guess * v * 10^(9 * j)
+		std::uint64_t carry(0);
+		bool borrow(false);
+		for (unsigned long int i(0); i <= m; i++)
 		{
-			X = X - R;
-			quotient += Z1;
+			carry += i < m ? guess * v[i] : 0;
+			const std::uint64_t subtrahend(carry % B + borrow);
+			carry /= B;
+			borrow = u[i + j] < subtrahend;
+			u[i + j] = (std::uint32_t) (u[i + j] + (borrow ? B : 0) - 
+					subtrahend);
+		}
+		
+		//the guess was one too big, add v back
+		if (borrow)
+		{
+			guess--;
+			carry = 0;
+			for (unsigned long int i(0); i <= m; i++)
+			{
+				carry += (std::uint64_t) u[i + j] + (i < m ? v[i] : 0);
+				u[i + j] = (std::uint32_t) (carry % B);
+				carry /= B;
+			}
 		}
+		quotient[j] = (std::uint32_t) guess;
+	}
+	trimWords(quotient);
+	
+	//unscale the remainder
+	u.resize(m);
+	std::uint64_t rest(0);
+	for (unsigned long int i(m); i > 0; i--)
+	{
+		rest = rest * B + u[i - 1];
+		u[i - 1] = (std::uint32_t) (rest / factor);
+		rest %= factor;
+	}
+	trimWords(u);
+	remainder = u;
+}
+
+/* The divisor length, in limbs, from which Newton's method is used. */
+static const unsigned long int NewtonThreshold(1000);
+
+/* Stores floor(10^(18k) / b), give or take a few units, into 
+ * "reciprocal", where b has k limbs. The reciprocal of the top half of b 
+ * (plus a few guard limbs) is computed recursively, and one step of 
+ * Newton's iteration 
+ * 
+ * 			x = x + x * (10^(18k) - b * x) / 10^(18k) 
+ * 
+ * doubles its precision. */
+static void reciprocalWords(const Words &b, Words &reciprocal)
+{
+	const unsigned long int k(b.size());
+	Words power(2 * k, 0), product, error, rest;
+	power.push_back(1);
+	if (k < NewtonThreshold)
+	{
+		longDivideWords(power, b, reciprocal, rest);
+		return;
+	}
+	
+	const unsigned long int h(k / 2 + 3);
+	const Words top(b.end() - h, b.end());
+	reciprocalWords(top, reciprocal);
+	shiftWords(reciprocal, k - h);
+	
+	multiplyWords<DecimalRadix>(&b[0], k, &reciprocal[0], reciprocal.size(), 
+			product);
+	trimWords(product);
+	const bool tooSmall(compareWords(product, power) != 1);
+	error = tooSmall ? power : product;
+	subtractWords<DecimalRadix>(error, tooSmall ? product : power);
+	trimWords(error);
+	if (!error.empty())
+	{
+		Words correction;
+		multiplyWords<DecimalRadix>(&reciprocal[0], reciprocal.size(), 
+				&error[0], error.size(), correction);
+		correction.erase(correction.begin(), correction.begin() + 
+				std::min(correction.size(), 2 * k));
+		trimWords(correction);
+		if (tooSmall)
+			addWords<DecimalRadix>(reciprocal, 
+					correction.empty() ? 0 : &correction[0], 
+					correction.size());
 		else
 		{
-			if (Z1.digitCount > 1)
-				Z1.shiftRight(1);
-			else
-				--Z1;
-			goto predictZ1;
+			//rounding the correction up keeps the result from being 
+			//too big
+			const std::uint32_t one(1);
+			addWords<DecimalRadix>(correction, &one, 1);
+			subtractWords<DecimalRadix>(reciprocal, correction);
 		}
+		trimWords(reciprocal);
+	}
+	
+}
+
+/* Divides "a" by "b", where a has at most twice as many limbs as b, using 
+ * the reciprocal of the top limbs of b. The quotient found is off by at 
+ * most a few units and is corrected by hand. */
+static void newtonDivideWords(	const Words &a, const Words &b, 
+								Words &quotient, Words &remainder)
+{
+	const unsigned long int n(a.size()), m(b.size());
+	if (compareWords(a, b) == 2)
+	{
+		quotient.clear();
+		remainder = a;
+		return;
+	}
+	
+	//the top k limbs of both numbers give the quotient to within a unit, 
+	//and the k - 2 limbs below the top n - m + 2 of a don't change it at all
+	const unsigned long int k(std::min(m, n - m + 2)), skip(m - 2);
+	const Words topA(a.begin() + skip, a.end()), topB(b.end() - k, b.end());
+	Words reciprocal, product;
+	reciprocalWords(topB, reciprocal);
+	multiplyWords<DecimalRadix>(&topA[0], topA.size(), 
+			&reciprocal[0], reciprocal.size(), product);
+	product.erase(product.begin(), product.begin() + 
+			std::min(product.size(), 2 * k - (skip - (m - k))));
+	trimWords(product);
+	quotient = product;
+	
+	const std::uint32_t one(1);
+	if (quotient.empty())
+		product.clear();
+	else
+	{
+		multiplyWords<DecimalRadix>(&quotient[0], quotient.size(), 
+				&b[0], m, product);
+		trimWords(product);
+	}
+	while (compareWords(product, a) == 1)
+	{
+		subtractWords<DecimalRadix>(quotient, Words(1, one));
+		subtractWords<DecimalRadix>(product, b);
+		trimWords(product);
+	}
+	trimWords(quotient);
+	remainder = a;
+	subtractWords<DecimalRadix>(remainder, product);
+	trimWords(remainder);
+	while (compareWords(remainder, b) != 2)
+	{
+		addWords<DecimalRadix>(quotient, &one, 1);
+		subtractWords<DecimalRadix>(remainder, b);
+		trimWords(remainder);
+	}
+}
+
+/* Divides decimal limbs "a" by "b", both without leading zero limbs. Long 
+ * divisors are divided using Newton's method, m limbs of the quotient at a 
+ * time, where m is the length of the divisor. */
+static void divideWords(const Words &a, const Words &b, 
+						Words &quotient, Words &remainder)
+{
+	const unsigned long int m(b.size());
+	if (m < NewtonThreshold)
+	{
+		longDivideWords(a, b, quotient, remainder);
+		return;
 	}
 	
-	remainder = X;
+	//like long division, with "digits" of m limbs
+	Words rest(a), partQuotient;
+	quotient.clear();
+	while (rest.size() > 2 * m)
+	{
+		const unsigned long int shift(rest.size() - 2 * m);
+		const Words top(rest.begin() + shift, rest.end());
+		newtonDivideWords(top, b, partQuotient, remainder);
+		shiftWords(partQuotient, shift);
+		addWords<DecimalRadix>(quotient, 
+				partQuotient.empty() ? 0 : &partQuotient[0], 
+				partQuotient.size());
+		rest.resize(shift);
+		rest.insert(rest.end(), remainder.begin(), remainder.end());
+		trimWords(rest);
+	}
+	newtonDivideWords(rest, b, partQuotient, remainder);
+	addWords<DecimalRadix>(quotient, 
+			partQuotient.empty() ? 0 : &partQuotient[0], partQuotient.size());
+	trimWords(quotient);
+}
+
+/* Divides two BigInt numbers by the formula 
+ * |dividend| = |divisor| * quotient + remainder, in decimal limbs. Short 
+ * divisors are divided the long way, long ones using Newton's method, which 
+ * costs a few multiplications. "remainder" may be "dividend". */
+void BigInt::divide(const BigInt &dividend, const BigInt &divisor, 
+					BigInt &quotient, BigInt &remainder)
+{
+	Words a, b, q, r;
+	dividend.toLimbs(a);
+	divisor.toLimbs(b);
+	trimWords(a);
+	trimWords(b);
+	divideWords(a, b, q, r);
+	quotient = fromLimbs(q);
+	remainder = fromLimbs(r);
 }
 
 /* Returns the value of the specified unsigned char[] as long int. */
@@ -627,12 +1380,7 @@ BigInt &BigInt::operator =(const BigInt &rightNumber)
 
 std::ostream &operator <<(std::ostream &cout, const BigInt &number)
 {
-	if (!number.positive)
-		cout << '-';
-    for (int i = number.digitCount - 1; i >= 0; i--)
-        cout << (int(number.digits[i]));
-
-	return cout;
+	return cout << number.ToString();
 }
 
 std::istream &operator >>(std::istream &cin, BigInt &number)
@@ -740,14 +1488,14 @@ BigInt operator +(const BigInt &a, const BigInt &b)
 /*overloaded ++ operator, prefix version*/
 BigInt &BigInt::operator++()
 {
-	return *this += BigIntOne;
+	return *this += 1UL;
 }
 
 /*overloaded ++ operator, postfix version*/							
 BigInt BigInt::operator++(int)
 {
 	BigInt temp(*this);
-	*this += BigIntOne;
+	*this += 1UL;
 	return temp;
 }
 
@@ -853,7 +1601,7 @@ BigInt operator-(const BigInt &a, const BigInt &b)
 /*overloaded -- operator, prefix version*/
 BigInt &BigInt::operator--()
 {
-	*this = *this - BigIntOne;
+	*this -= 1UL;
 	return *this;
 }
 
@@ -861,7 +1609,7 @@ BigInt &BigInt::operator--()
 BigInt BigInt::operator--(int)
 {
 	BigInt temp(*this);
-	*this = *this - BigIntOne;
+	*this -= 1UL;
 	return temp;
 }
 
@@ -878,14 +1626,16 @@ BigInt operator*(const BigInt &a, const BigInt &b)
 	
 	//this controls wether Karatsuba algorithm will be used for multiplication
 #ifdef KARATSUBA	 
-	int n((a.digitCount < b.digitCount ? b.digitCount : a.digitCount));
-			
+	int n = a.digitCount + b.digitCount;
+	
 	//we will use a temporary buffer for multiplication
 	unsigned char *buffer(0);
 	
 	try
 	{
-		buffer = new unsigned char[11 * n];
+		buffer = new unsigned char[n];
+		BigInt::blockMultiply(	a.digits, a.digitCount, 
+								b.digits, b.digitCount, buffer);
 	}
 	catch (...)
 	{
@@ -893,16 +1643,7 @@ BigInt operator*(const BigInt &a, const BigInt &b)
 		throw "Error BIGINT10: Not enough memory?";
 	}
 	
-	unsigned char *bb(buffer + n), *bc(bb + n);
-	
-	std::copy(a.digits, a.digits + a.digitCount, buffer);
-	std::fill(buffer + a.digitCount, buffer + n, 0);	
-	std::copy(b.digits, b.digits + b.digitCount, bb);
-	std::fill(bb + b.digitCount, bb + n, 0);
-	
-	BigInt::karatsubaMultiply(buffer, bb, n, bc);
-	
-	n <<= 1;
+	unsigned char *bc(buffer);
 #else  
 	int n = a.digitCount + b.digitCount;
 	
@@ -1002,62 +1743,803 @@ BigInt &BigInt::operator%=(const BigInt &number)
 	return *this;
 }
 
-/* Returns *this to the power of n 
- * using the fast Square and Multiply algorithm. */
-BigInt BigInt::GetPower(unsigned long int n) const
+/* Compares the absolute value with "number". Returns 0 if they are equal, 
+ * 1 if the absolute value is greater, 2 if it's less. */
+int BigInt::compareWord(unsigned long int number) const
 {
-	BigInt result(BigIntOne);
-	BigInt base(*this);
-	
-	while (n)
+	unsigned char numberDigits[40];
+	const unsigned long int numberCount(int2uchar(number, numberDigits));
+	return compareNumbers(digits, digitCount, numberDigits, numberCount);
+}
+
+/* Adds "number" to the absolute value. */
+void BigInt::addWord(unsigned long int number)
+{
+	//an unsigned long int has at most 20 digits, plus one for the carry
+	if (length < digitCount + 21)
+		expandTo(digitCount + 21);
+	for (unsigned long int i(0); number; i++)
 	{
-		//if n is odd
-		if (n & 1)
+		if (i == digitCount)
+			digits[digitCount++] = 0;
+		unsigned long int digit(digits[i] + number % 10);
+		number /= 10;
+		if (digit >= 10)
 		{
-			result = result * base;
-			n--;
+			digit -= 10;
+			number++;
 		}
-		n /= 2;
-		base = base * base;
+		digits[i] = digit;
 	}
-	
-	//number was negative and the exponent is odd, the result is negative
-	if (!positive && (n & 1))
-		result.positive = false;
-	return result;
 }
 
-/* *this = *this to the power of n. */
-void BigInt::SetPower(unsigned long int n)
+/* Subtracts "number" from the absolute value, which must not be less than 
+ * "number". */
+void BigInt::subtractWord(unsigned long int number)
 {
-	*this = (*this).GetPower(n);
+	bool borrow(false);
+	for (unsigned long int i(0); number || borrow; i++)
+	{
+		int digit(digits[i] - int(number % 10) - borrow);
+		number /= 10;
+		borrow = digit < 0;
+		digits[i] = borrow ? digit + 10 : digit;
+	}
+	while (digitCount > 1 && digits[digitCount - 1] == 0)
+		digitCount--;
+	if (EqualsZero())
+		positive = true;
 }
 
-/* Returns *this to the power of n 
- * using the fast Square and Multiply algorithm. */
-BigInt BigInt::GetPower(BigInt n) const
+/* Multiplies the absolute value by "number", which must be at most 
+ * ULONG_MAX / 10. */
+void BigInt::multiplyWord(unsigned long int number)
 {
-	if (!n.positive)
-		throw "Error BIGINT13: Negative exponents not supported!";
+	if (number == 0)
+	{
+		*this = BigIntZero;
+		return;
+	}
+	if (length < digitCount + 21)
+		expandTo(digitCount + 21);
+	//a digit times "number" plus the carry never exceeds 10 * number
+	unsigned long int carry(0);
+	for (unsigned long int i(0); i < digitCount; i++)
+	{
+		carry += digits[i] * number;
+		digits[i] = carry % 10;
+		carry /= 10;
+	}
+	for (; carry; carry /= 10)
+		digits[digitCount++] = carry % 10;
+}
+
+/* Divides the absolute value by "number", which must be at most 
+ * ULONG_MAX / 10, and returns the remainder. */
+unsigned long int BigInt::divideWord(unsigned long int number)
+{
+	unsigned long int remainder(0);
+	for (unsigned long int i(digitCount); i > 0; i--)
+	{
+		remainder = remainder * 10 + digits[i - 1];
+		digits[i - 1] = remainder / number;
+		remainder %= number;
+	}
+	while (digitCount > 1 && digits[digitCount - 1] == 0)
+		digitCount--;
+	if (EqualsZero())
+		positive = true;
+	return remainder;
+}
+
+/* Compares "a" with "b". Returns 0 if a == b, 1 if a > b, 2 if a < b. */
+int BigInt::compareWithWord(const BigInt &a, unsigned long int b)
+{
+	return a.positive ? a.compareWord(b) : 2;
+}
+
+bool operator <(const BigInt &a, unsigned long int b)
+{
+	return BigInt::compareWithWord(a, b) == 2;
+}
+
+bool operator <(unsigned long int a, const BigInt &b)
+{
+	return BigInt::compareWithWord(b, a) == 1;
+}
+
+bool operator <=(const BigInt &a, unsigned long int b)
+{
+	return BigInt::compareWithWord(a, b) != 1;
+}
+
+bool operator <=(unsigned long int a, const BigInt &b)
+{
+	return BigInt::compareWithWord(b, a) != 2;
+}
+
+bool operator >(const BigInt &a, unsigned long int b)
+{
+	return BigInt::compareWithWord(a, b) == 1;
+}
+
+bool operator >(unsigned long int a, const BigInt &b)
+{
+	return BigInt::compareWithWord(b, a) == 2;
+}
+
+bool operator >=(const BigInt &a, unsigned long int b)
+{
+	return BigInt::compareWithWord(a, b) != 2;
+}
+
+bool operator >=(unsigned long int a, const BigInt &b)
+{
+	return BigInt::compareWithWord(b, a) != 1;
+}
+
+bool operator ==(const BigInt &a, unsigned long int b)
+{
+	return BigInt::compareWithWord(a, b) == 0;
+}
+
+bool operator ==(unsigned long int a, const BigInt &b)
+{
+	return BigInt::compareWithWord(b, a) == 0;
+}
+
+bool operator !=(const BigInt &a, unsigned long int b)
+{
+	return BigInt::compareWithWord(a, b) != 0;
+}
+
+bool operator !=(unsigned long int a, const BigInt &b)
+{
+	return BigInt::compareWithWord(b, a) != 0;
+}
+
+BigInt operator+(const BigInt &a, unsigned long int b)
+{
+	BigInt sum(a);
+	return sum += b;
+}
+
+BigInt operator+(unsigned long int a, const BigInt &b)
+{
+	BigInt sum(b);
+	return sum += a;
+}
+
+BigInt &BigInt::operator+=(unsigned long int number)
+{
+	if (positive)
+		addWord(number);
+	else if (compareWord(number) != 2)
+		subtractWord(number);
+	else
+		//-|x| + number, where number > |x|
+		*this = BigInt(number - toInt(digits, digitCount));
+	return *this;
+}
+
+BigInt operator-(const BigInt &a, unsigned long int b)
+{
+	BigInt difference(a);
+	return difference -= b;
+}
+
+BigInt operator-(unsigned long int a, const BigInt &b)
+{
+	return -(b - a);
+}
+
+BigInt &BigInt::operator-=(unsigned long int number)
+{
+	if (!positive)
+		addWord(number);
+	else if (compareWord(number) != 2)
+		subtractWord(number);
+	else
+	{
+		//|x| - number, where number > |x|
+		*this = BigInt(number - toInt(digits, digitCount));
+		positive = false;
+	}
+	return *this;
+}
+
+BigInt operator*(const BigInt &a, unsigned long int b)
+{
+	BigInt product(a);
+	return product *= b;
+}
+
+BigInt operator*(unsigned long int a, const BigInt &b)
+{
+	BigInt product(b);
+	return product *= a;
+}
+
+BigInt &BigInt::operator*=(unsigned long int number)
+{
+	if (number > ULONG_MAX / 10)
+		return *this = *this * BigInt(number);
+	multiplyWord(number);
+	return *this;
+}
+
+BigInt operator/(const BigInt &a, unsigned long int b)
+{
+	BigInt quotient(a);
+	quotient.DivideBy(b);
+	return quotient;
+}
+
+BigInt &BigInt::operator/=(unsigned long int number)
+{
+	DivideBy(number);
+	return *this;
+}
+
+BigInt operator%(const BigInt &a, unsigned long int b)
+{
+	BigInt remainder(a);
+	return remainder %= b;
+}
+
+BigInt &BigInt::operator%=(unsigned long int number)
+{
+	//like operator%, the remainder has the sign of the dividend
+	const bool sign(positive);
+	*this = BigInt(DivideBy(number));
+	if (!EqualsZero())
+		positive = sign;
+	return *this;
+}
+
+/* *this = *this / divisor. Returns the remainder of the division of the 
+ * absolute values. */
+unsigned long int BigInt::DivideBy(unsigned long int divisor)
+{
+	if (divisor == 0)
+		throw "Error BIGINT12: Attempt to divide by zero.";
+	if (divisor <= ULONG_MAX / 10)
+		return divideWord(divisor);
+	
+	//the remainder still fits into an unsigned long int
+	BigInt quotient, remainder;
+	divide(Abs(), BigInt(divisor), quotient, remainder);
+	if (!positive && !quotient.EqualsZero())
+		quotient.positive = false;
+	*this = quotient;
+	return toInt(remainder.digits, remainder.digitCount);
+}
+
+/* Returns *this / divisor, where divisor is known to divide *this. If it 
+ * doesn't, the result is meaningless. 
+ * 
+ * Hensel division needs a divisor coprime to the base, so the factors 2^a 
+ * and 5^b of the divisor are removed first: both numbers are multiplied by 
+ * 5^a * 2^b, which makes the divisor d * 10^(a + b), and the low a + b 
+ * digits are dropped. The rest is done in limbs of nine digits. Going from 
+ * the lowest limb up, each quotient limb is the current lowest limb of 
+ * the dividend times the inverse of the divisor modulo 10^9, and its 
+ * multiple of the divisor is subtracted. The quotient is known to be 
+ * shorter than the dividend, so the limbs above it are never updated. */
+BigInt BigInt::DivExact(const BigInt &divisor) const
+{
+	if (divisor.EqualsZero())
+		throw "Error BIGINT12: Attempt to divide by zero.";
+	
+	//the trailing zeroes of the divisor are also trailing zeroes of *this
+	unsigned long int zeroes(0);
+	while (divisor.digits[zeroes] == 0)
+		zeroes++;
+	if (zeroes >= digitCount)
+		return BigIntZero;
+	BigInt dividend, d;
+	dividend.expandTo(digitCount - zeroes + 1);
+	std::copy(digits + zeroes, digits + digitCount, dividend.digits);
+	dividend.digitCount = digitCount - zeroes;
+	d.expandTo(divisor.digitCount - zeroes + 1);
+	std::copy(	divisor.digits + zeroes, divisor.digits + divisor.digitCount, 
+				d.digits);
+	d.digitCount = divisor.digitCount - zeroes;
+	
+	//now only one of 2 and 5 can divide the divisor
+	const unsigned long int twos(d.TrailingZeros());
+	unsigned long int fives(0);
+	for (BigInt rest(d); rest.digits[0] == 5; fives++)
+		rest.DivideBy(5);
+	if (twos || fives)
+	{
+		const BigInt factor(	BigInt(5UL).GetPower(twos) * 
+								BigInt(2UL).GetPower(fives));
+		BigInt quotient((dividend * factor).DivExact(d * factor));
+		quotient.positive = quotient.EqualsZero() || 
+				positive == divisor.positive;
+		return quotient;
+	}
+	
+	std::vector<std::uint32_t> rest, limbs;
+	dividend.toLimbs(rest);
+	d.toLimbs(limbs);
+	if (rest.size() < limbs.size())
+		return BigIntZero;
+	
+	//the inverse of the lowest limb modulo 10, lifted to 10^2, 10^4, 10^8 
+	//and 10^16 by Newton's iteration x = x * (2 - limb * x)
+	static const std::uint64_t inverses[10] = {0, 1, 0, 7, 0, 0, 0, 3, 0, 9};
+	std::uint64_t inverse(inverses[limbs[0] % 10]);
+	for (int i(0); i < 4; i++)
+		inverse = inverse * ((2 + DecimalRadix - 
+				(std::uint64_t) limbs[0] * inverse % DecimalRadix) % 
+				DecimalRadix) % DecimalRadix;
+	
+	std::vector<std::uint32_t> quotient(rest.size() - limbs.size() + 1);
+	for (unsigned long int i(0); i < quotient.size(); i++)
+	{
+		const std::uint64_t q((std::uint64_t) rest[i] * inverse % 
+				DecimalRadix);
+		quotient[i] = (std::uint32_t) q;
+		
+		//rest -= q * divisor * 10^(9 * i), up to the top of the quotient
+		std::uint64_t carry(0);
+		for (unsigned long int j(0); i + j < quotient.size() && 
+				(j < limbs.size() || carry); j++)
+		{
+			carry += j < limbs.size() ? q * limbs[j] : 0;
+			const std::uint32_t low((std::uint32_t) (carry % DecimalRadix));
+			carry /= DecimalRadix;
+			if (rest[i + j] < low)
+			{
+				rest[i + j] += (std::uint32_t) DecimalRadix;
+				carry++;
+			}
+			rest[i + j] -= low;
+		}
+	}
+	BigInt result(fromLimbs(quotient));
+	result.positive = result.EqualsZero() || positive == divisor.positive;
+	return result;
+}
+
+/* The length of the shorter operand, in limbs, from which short products 
+ * use Karatsuba multiplication instead of the truncated long way. */
+static const unsigned long int ShortProductThreshold(200);
+
+/* result = (a * b) mod 10^(9k), in decimal limbs. Short operands are 
+ * multiplied the long way, skipping the limb products above the lowest k 
+ * limbs. Long ones are split at l = 0.7k limbs (Mulders' short product): 
+ * the low l limbs are multiplied in full, and the two cross products only 
+ * need their lowest k - l limbs. */
+static void lowWords(	const std::uint32_t *a, unsigned long int na, 
+						const std::uint32_t *b, unsigned long int nb, 
+						unsigned long int k, Words &result)
+{
+	na = std::min(na, k);
+	nb = std::min(nb, k);
+	if (na < nb)
+	{
+		std::swap(a, b);
+		std::swap(na, nb);
+	}
+	if (nb < ShortProductThreshold)
+	{
+		result.assign(std::min(k, na + nb), 0);
+		for (unsigned long int i(0); i < nb; i++)
+		{
+			std::uint64_t carry(0);
+			for (unsigned long int j(0); j < na && i + j < k; j++)
+			{
+				carry += (std::uint64_t) a[j] * b[i] + result[i + j];
+				result[i + j] = (std::uint32_t) (carry % DecimalRadix);
+				carry /= DecimalRadix;
+			}
+			if (i + na < k)
+				result[i + na] = (std::uint32_t) carry;
+		}
+		return;
+	}
+	
+	const unsigned long int l((7 * k + 9) / 10);
+	multiplyWords<DecimalRadix>(a, std::min(na, l), b, std::min(nb, l), 
+			result);
+	Words cross;
+	if (na > l)
+	{
+		lowWords(a + l, na - l, b, nb, k - l, cross);
+		addWords<DecimalRadix>(result, cross.empty() ? 0 : &cross[0], 
+				cross.size(), l);
+	}
+	if (nb > l)
+	{
+		lowWords(a, na, b + l, nb - l, k - l, cross);
+		addWords<DecimalRadix>(result, cross.empty() ? 0 : &cross[0], 
+				cross.size(), l);
+	}
+	result.resize(std::min(result.size(), k));
+}
+
+/* result = floor(S / 10^(9 first)), in decimal limbs, where S is the sum 
+ * of the limb products a[j] * b[i] * 10^(9(i + j)) with i + j >= first, 
+ * and maybe of some of the others. Short operands are multiplied the long 
+ * way, skipping the other limb products. Long ones are split like in 
+ * lowWords(), mirrored: the top l = 0.7h limbs, where h is the number of 
+ * columns from "first" up, are multiplied in full, and the two products 
+ * with the rest of the limbs only need their columns from "first" up. 
+ * Every split loses less than one in the lowest limb of the result. */
+static void highWords(	const std::uint32_t *a, unsigned long int na, 
+						const std::uint32_t *b, unsigned long int nb, 
+						unsigned long int first, Words &result)
+{
+	//the limbs of one operand whose products with the other one all fall 
+	//below column "first" are not needed
+	if (nb && first > nb - 1)
+	{
+		const unsigned long int skip(std::min(na, first - (nb - 1)));
+		a += skip;
+		na -= skip;
+		first -= skip;
+	}
+	if (na && first > na - 1)
+	{
+		const unsigned long int skip(std::min(nb, first - (na - 1)));
+		b += skip;
+		nb -= skip;
+		first -= skip;
+	}
+	if (na == 0 || nb == 0)
+	{
+		result.clear();
+		return;
+	}
+	if (na < nb)
+	{
+		std::swap(a, b);
+		std::swap(na, nb);
+	}
+	
+	if (nb < ShortProductThreshold)
+	{
+		//column "first" is stored in result[0]
+		result.assign(na + nb - first, 0);
+		for (unsigned long int i(0); i < nb; i++)
+		{
+			if (i + na <= first)
+				continue;
+			std::uint64_t carry(0);
+			for (unsigned long int j(i < first ? first - i : 0); j < na; j++)
+			{
+				carry += (std::uint64_t) a[j] * b[i] + result[i + j - first];
+				result[i + j - first] = (std::uint32_t) (carry % DecimalRadix);
+				carry /= DecimalRadix;
+			}
+			result[i + na - first] = (std::uint32_t) carry;
+		}
+		return;
+	}
+	
+	//the top product begins at column ja + ib
+	const unsigned long int l((7 * (na + nb - 1 - first) + 9) / 10);
+	const unsigned long int ja(na > l ? na - l : 0), ib(nb > l ? nb - l : 0);
+	multiplyWords<DecimalRadix>(a + ja, na - ja, b + ib, nb - ib, result);
+	if (ja + ib < first)
+		result.erase(result.begin(), result.begin() + (first - ja - ib));
+	else
+		result.insert(result.begin(), ja + ib - first, 0);
+	Words rest;
+	if (ja)
+	{
+		highWords(a, ja, b, nb, first, rest);
+		addWords<DecimalRadix>(result, rest.empty() ? 0 : &rest[0], 
+				rest.size());
+	}
+	if (ib)
+	{
+		//this product begins at column ja
+		highWords(a + ja, na - ja, b, ib, first > ja ? first - ja : 0, rest);
+		addWords<DecimalRadix>(result, rest.empty() ? 0 : &rest[0], 
+				rest.size(), first > ja ? 0 : ja - first);
+	}
+}
+
+/* Returns |a * b| mod 10^k. Only the lowest k digits of the product are 
+ * computed. */
+BigInt BigInt::MulLow(const BigInt &a, const BigInt &b, unsigned long int k)
+{
+	if (k == 0)
+		return BigIntZero;
+	Words x, y, product;
+	a.toLimbs(x);
+	b.toLimbs(y);
+	lowWords(&x[0], x.size(), &y[0], y.size(), (k + 8) / 9, product);
+	BigInt result(fromLimbs(product));
+	if (result.digitCount > k)
+	{
+		result.digitCount = k;
+		while (result.digitCount > 1 && !result.digits[result.digitCount - 1])
+			result.digitCount--;
+	}
+	return result;
+}
+
+/* Returns floor(|a * b| / 10^k), or one less. The products of the digits 
+ * far below the kth are skipped. */
+BigInt BigInt::MulHigh(const BigInt &a, const BigInt &b, unsigned long int k)
+{
+	Words x, y, product;
+	a.toLimbs(x);
+	b.toLimbs(y);
+	//two more limbs are computed: the skipped limb products are less than 
+	//nb * 10^(9(first + 1)), and every split of highWords() loses less 
+	//than 10^(9 first), so together they take at most one from the result 
+	//as long as the operands are shorter than about 10^9 limbs
+	const unsigned long int first(k / 9 > 2 ? k / 9 - 2 : 0);
+	highWords(&x[0], x.size(), &y[0], y.size(), first, product);
+	product.erase(product.begin(), 
+			product.begin() + std::min(product.size(), k / 9 - first));
+	
+	//drop the remaining k mod 9 digits
+	std::uint32_t divisor(1);
+	for (unsigned long int i(0); i < k % 9; i++)
+		divisor *= 10;
+	std::uint64_t rest(0);
+	for (unsigned long int i(product.size()); i > 0; i--)
+	{
+		rest = rest * DecimalRadix + product[i - 1];
+		product[i - 1] = (std::uint32_t) (rest / divisor);
+		rest %= divisor;
+	}
+	return fromLimbs(product);
+}
+
+/* Returns the lowest 64 bits of the absolute value. Since 10^64 is a 
+ * multiple of 2^64, only the lowest 64 digits matter, and the arithmetic 
+ * can simply overflow. */
+std::uint64_t BigInt::lowBits() const
+{
+	std::uint64_t bits(0);
+	for (unsigned long int i(digitCount < 64 ? digitCount : 64); i > 0; i--)
+		bits = bits * 10 + digits[i - 1];
+	return bits;
+}
+
+/* Returns "number" with the sign of "sign", or zero. */
+static BigInt withSign(BigInt number, const BigInt &sign)
+{
+	return sign.IsPositive() || number.EqualsZero() ? number : -number;
+}
+
+/* Combines the words of a and b with "operation", the longer number being 
+ * padded with zero words. */
+template <typename Operation>
+static BigInt combineWords(	const BigInt &a, const BigInt &b, 
+							Operation operation)
+{
+	std::vector<std::uint32_t> wordsA, wordsB;
+	a.ToWords(wordsA);
+	b.ToWords(wordsB);
+	if (wordsA.size() < wordsB.size())
+		wordsA.resize(wordsB.size(), 0);
+	for (unsigned long int i(0); i < wordsA.size(); i++)
+		wordsA[i] = operation(wordsA[i], i < wordsB.size() ? wordsB[i] : 0);
+	return BigInt::FromWords(wordsA);
+}
+
+BigInt operator<<(const BigInt &a, unsigned long int n)
+{
+	std::vector<std::uint32_t> words;
+	a.ToWords(words);
+	if (words.empty())
+		return BigIntZero;
+	
+	const unsigned long int bitShift(n % 32);
+	words.insert(words.begin(), n / 32, 0);
+	if (bitShift)
+	{
+		words.push_back(0);
+		for (unsigned long int i(words.size() - 1); i > n / 32; i--)
+			words[i] = (words[i] << bitShift) | 
+					(words[i - 1] >> (32 - bitShift));
+		words[n / 32] <<= bitShift;
+	}
+	return withSign(BigInt::FromWords(words), a);
+}
+
+BigInt &BigInt::operator<<=(unsigned long int n)
+{
+	*this = *this << n;
+	return *this;
+}
+
+BigInt operator>>(const BigInt &a, unsigned long int n)
+{
+	std::vector<std::uint32_t> words;
+	a.ToWords(words);
+	if (n / 32 >= words.size())
+		return BigIntZero;
+	
+	const unsigned long int bitShift(n % 32);
+	words.erase(words.begin(), words.begin() + n / 32);
+	if (bitShift)
+	{
+		for (unsigned long int i(0); i + 1 < words.size(); i++)
+			words[i] = (words[i] >> bitShift) | 
+					(words[i + 1] << (32 - bitShift));
+		words.back() >>= bitShift;
+	}
+	return withSign(BigInt::FromWords(words), a);
+}
+
+BigInt &BigInt::operator>>=(unsigned long int n)
+{
+	*this = *this >> n;
+	return *this;
+}
+
+/* Returns the bitwise and of a word. */
+static std::uint32_t andWords(std::uint32_t a, std::uint32_t b)
+{
+	return a & b;
+}
+
+/* Returns the bitwise or of a word. */
+static std::uint32_t orWords(std::uint32_t a, std::uint32_t b)
+{
+	return a | b;
+}
+
+/* Returns the bitwise exclusive or of a word. */
+static std::uint32_t xorWords(std::uint32_t a, std::uint32_t b)
+{
+	return a ^ b;
+}
+
+BigInt operator&(const BigInt &a, const BigInt &b)
+{
+	return combineWords(a, b, andWords);
+}
+
+BigInt &BigInt::operator&=(const BigInt &number)
+{
+	*this = *this & number;
+	return *this;
+}
+
+BigInt operator|(const BigInt &a, const BigInt &b)
+{
+	return combineWords(a, b, orWords);
+}
+
+BigInt &BigInt::operator|=(const BigInt &number)
+{
+	*this = *this | number;
+	return *this;
+}
+
+BigInt operator^(const BigInt &a, const BigInt &b)
+{
+	return combineWords(a, b, xorWords);
+}
+
+BigInt &BigInt::operator^=(const BigInt &number)
+{
+	*this = *this ^ number;
+	return *this;
+}
+
+/* Returns the number of bits of the absolute value. */
+unsigned long int BigInt::BitLength() const
+{
+	std::vector<std::uint32_t> words;
+	ToWords(words);
+	if (words.empty())
+		return 0;
+	unsigned long int length(32 * (words.size() - 1));
+	for (std::uint32_t top(words.back()); top; top >>= 1)
+		length++;
+	return length;
+}
+
+/* Returns the value of the 'index'th bit of the absolute value 
+ * (zero-based, least significant first). */
+bool BigInt::TestBit(unsigned long int index) const
+{
+	if (index < 64)
+		return (lowBits() >> index) & 1;
+	
+	std::vector<std::uint32_t> words;
+	ToWords(words);
+	return index / 32 < words.size() && 
+			((words[index / 32] >> (index % 32)) & 1);
+}
+
+/* Sets the 'index'th bit of the absolute value to 1. */
+void BigInt::SetBit(unsigned long int index)
+{
+	if (TestBit(index))
+		return;
 	
+	//the bit is zero, so setting it adds 2^index to the absolute value
+	const BigInt power(BigIntOne << index);
+	*this = positive ? *this + power : *this - power;
+}
+
+/* Returns the number of zero bits below the lowest one bit, or 0 if *this 
+ * equals 0. */
+unsigned long int BigInt::TrailingZeros() const
+{
+	std::uint64_t bits(lowBits());
+	unsigned long int count(0);
+	if (bits == 0)
+	{
+		if (EqualsZero())
+			return 0;
+		std::vector<std::uint32_t> words;
+		ToWords(words);
+		for (; words[count / 32] == 0; count += 32)
+			;
+		bits = words[count / 32];
+	}
+	for (; !(bits & 1); bits >>= 1)
+		count++;
+	return count;
+}
+
+/* Returns *this to the power of n 
+ * using the fast Square and Multiply algorithm. */
+BigInt BigInt::GetPower(unsigned long int n) const
+{
 	BigInt result(BigIntOne);
 	BigInt base(*this);
-	BigInt bigIntTwo(BigIntOne + BigIntOne);
 	
-	while (!n.EqualsZero())
+	while (n)
 	{
 		//if n is odd
-		if (n.digits[0] & 1)
+		if (n & 1)
 		{
 			result = result * base;
 			n--;
 		}
-		n = n / bigIntTwo;
+		n /= 2;
 		base = base * base;
 	}
 	
 	//number was negative and the exponent is odd, the result is negative
-	if (!positive && (n.digits[0] & 1))
+	if (!positive && (n & 1))
+		result.positive = false;
+	return result;
+}
+
+/* *this = *this to the power of n. */
+void BigInt::SetPower(unsigned long int n)
+{
+	*this = (*this).GetPower(n);
+}
+
+/* Returns *this to the power of n 
+ * using the fast Square and Multiply algorithm. */
+BigInt BigInt::GetPower(BigInt n) const
+{
+	if (!n.positive)
+		throw "Error BIGINT13: Negative exponents not supported!";
+	
+	BigInt result(BigIntOne);
+	BigInt base(*this);
+	std::vector<bool> bits;
+	toBits(n, bits);
+	
+	for (unsigned long int i(0); i < bits.size(); i++)
+	{
+		if (bits[i])
+			result = result * base;
+		if (i + 1 < bits.size())
+			base = base * base;
+	}
+	
+	//number was negative and the exponent is odd, the result is negative
+	if (!positive && n.IsOdd())
 		result.positive = false;
 	return result;
 }
@@ -1079,34 +2561,27 @@ BigInt BigInt::GetPowerMod(const BigInt &b, const BigInt &n) const
 /* *this = (*this to the power of b) mod n. */
 void BigInt::SetPowerMod(const BigInt &b, const BigInt &n)
 {
-	if (!b.positive)
-		throw "Error BIGINT14: Negative exponent not supported.";
-	//we will need this value later, since *this is going to change
-	const BigInt a(*this);
-	//temporary variables
-	BigInt bCopy(b), q, r;
-	const BigInt two(BigIntOne + BigIntOne);
-	
-	//first we will find the binary representation of b
-	std::vector<bool> bits;
-	while (!bCopy.EqualsZero())
-	{
-		BigInt::divide(bCopy, two, q, r);
-		bCopy = q;
-		if (r.EqualsZero())
-			bits.push_back(false);
-		else
-			bits.push_back(true);
-	}
-	
-	//do the exponentiating
-	*this = BigIntOne;
-	for (int i = (int) bits.size() - 1; i >= 0; i--)
-	{
-		BigInt::divide(*this * *this, n, q, *this);
-		if (bits[i])
-			BigInt::divide(*this * a, n, q, *this);
-	}
+	std::vector<BigInt> numbers(1, *this);
+	BigInt::PowerModBatch(numbers, b, n);
+	*this = numbers[0];
+}
+
+/* numbers[i] = (numbers[i] to the power of b) mod n, for every i. 
+ * All the numbers are exponentiated in lockstep, one bit of the exponent 
+ * at a time, so the exponent is converted to binary only once. */
+void BigInt::PowerModBatch(	std::vector<BigInt> &numbers, 
+							const BigInt &b, const BigInt &n)
+{
+	BarrettContext(n).PowerModBatch(numbers, b);
+}
+
+/* Returns the product of (bases[i] to the power of exponents[i]) mod n, 
+ * for every i. */
+BigInt BigInt::MultiPowMod(	const std::vector<BigInt> &bases, 
+							const std::vector<BigInt> &exponents, 
+							const BigInt &n)
+{
+	return BarrettContext(n).MultiPowMod(bases, exponents);
 }
 
 /* Returns the nth digit read-only, zero-based, right-to-left. */
@@ -1132,11 +2607,10 @@ void BigInt::SetDigit(unsigned long int index, unsigned char value)
 /* Returns the value of BigInt as std::string. */
 std::string BigInt::ToString(bool forceSign) const
 {
-	std::string number;
-	if (!positive)
-		number.push_back('-');
-	for (int i = digitCount - 1; i >= 0; i--)
-		number.push_back(char(digits[i]) + '0');
+	std::string number(positive ? "" : "-");
+	number.reserve(digitCount + 1);
+	for (unsigned long int i(digitCount); i > 0; i--)
+		number.push_back(char(digits[i - 1]) + '0');
 	
 	return number;
 }
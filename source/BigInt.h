@@ -64,9 +64,26 @@
  * 		significantly faster than long multiplication, if the numbers are 
  * 		big enough. Currently, the long multiplication is better implemented, 
  * 		and runs faster than the Karatsuba multiplication for numbers shorter 
- * 		than about 100 digits. 
+ * 		than about 100 digits. Numbers of different lengths are not padded: 
+ * 		the longer one is multiplied by the shorter one in blocks, so 
+ * 		multiplying n digits by m digits costs about n / m products of m 
+ * 		digits. 
+ * 		MulLow() and MulHigh() compute only the low or the high digits of a 
+ * 		product (see BarrettContext). That is about half of the work for 
+ * 		numbers shorter than about 1800 digits. Longer ones are split like 
+ * 		in Mulders' short product, which takes about 80% of the work. 
+ * 		The top recursion levels of products of several thousand digits 
+ * 		compute their partial products in parallel, on the threads of 
+ * 		ThreadPool::GetDefault(). 
  * 
  * 	- C-style integer division 	(/, /=)
+ * 		The numbers are divided in limbs of nine decimal digits. Divisors 
+ * 		shorter than about 9000 digits are divided the long way, longer ones 
+ * 		using Newton's method for the reciprocal, which costs a few 
+ * 		multiplications. When the divisor is known to divide the number, 
+ * 		DivExact() is several times faster. It finds the quotient from the 
+ * 		lowest digits up (Hensel division), so no quotient digits need to 
+ * 		be guessed. 
  * 
  * 	- C-style integer division remainder (%, %=)
  * 		When calculating the remainder, the number is first divided. 
@@ -74,11 +91,35 @@
  * 	- comparison 				(==, !=, <, <=, >, >=)
  * 		All of the <, <=, >, >= operators are equally fast. 
  * 
+ * 	- arithmetic and comparison with unsigned long int operands 
+ * 		These run a single loop over the digits, in place, without making 
+ * 		a BigInt out of the other operand. DivideBy() divides by an 
+ * 		unsigned long int and returns the remainder as an unsigned long int. 
+ * 
+ * 	- bit shifts and bitwise operations 	(<<, <<=, >>, >>=, &, &=, |, |=, 
+ * 		^, ^=, BitLength(), TestBit(), SetBit(), TrailingZeros())
+ * 		These work on the absolute value. Shifts keep the sign (so a right 
+ * 		shift rounds toward zero), and &, | and ^ give a positive result. 
+ * 		The lowest 64 bits of a number only depend on its lowest 64 decimal 
+ * 		digits, so TestBit() of a low bit and TrailingZeros() of a number 
+ * 		with a one in its low bits don't convert the whole number. 
+ * 		The other operations go through the binary representation 
+ * 		(see ToWords()). 
+ * 
  * 	- exponentiation 	(GetPower(), SetPower(), GetPowerMod(), SetPowerMod())
  * 		For exponentiation, the Exponantiation by squaring 
  * 		(or Square and multiply or Binary exponentiation) algorithm is used. 
  * 		It uses O(log(n)) multiplications and therefore is significantly faster
  * 		than multiplying x with itself n-1 times. 
+ * 		Many numbers can be raised to the same power modulo the same number 
+ * 		in one call (PowerModBatch()). The exponent is then split into 
+ * 		sliding windows only once for the whole batch, and each number 
+ * 		takes a multiplication per window instead of per bit set. The 
+ * 		exponent 65537, used by most public RSA keys, takes just 16 
+ * 		squarings and a multiplication. The products are reduced using 
+ * 		Barrett reduction (see BarrettContext). 
+ * 		A product of powers like (a^x * b^y) mod n is computed in one call 
+ * 		(MultiPowMod()), which shares the squarings between the powers. 
  * 
  * In addition to mathematical operations, BigInt supports: 
  * 
@@ -91,6 +132,11 @@
  * 	- returning the number of digits (Length())
  * 	- returning a string of digits (ToString())
  * 		This can be useful for human-readable output. 
+ * 	- conversion to and from binary 32-bit words (ToWords(), FromWords())
+ * 		and bytes (ToBytes(), FromBytes()) 
+ * 		Both directions split the number in half recursively and join the 
+ * 		halves using cached powers of 10 or 2, so a number with millions 
+ * 		of digits isn't converted one digit at a time. 
  * 	- returning a value indicating wether the number is odd (IsOdd())
  * 	- returning a value indicating wether the number is positive (IsPositive())
  * 	- returning a value indicating wether the BigInt equals zero (EqualsZero())
@@ -113,9 +159,16 @@
 #include <iostream>	//ostream, istream
 #include <cmath>	//sqrt()
 #include <string>	//ToString(), BigInt(std::string)
+#include <vector>	//PowerModBatch()
+#include <cstdint>	//uint32_t, uint8_t
+#include <cstddef>	//size_t
 
 class BigInt
 {
+	/* BarrettContext works with the digits directly. */
+	friend class BarrettContext;
+	/* FixedBase uses the binary representation of exponents. */
+	friend class FixedBase;
 	private:
 		/* An array of digits stored right to left,
 		* i.e. int 345 = unsigned char {[5], [4], [3]} */
@@ -148,10 +201,18 @@ class BigInt
 		                            bool aPositive = true, 
 		                            bool bPositive = true);
 		/* Multiplies two unsigned char[] using the Divide and Conquer 
-		 * a.k.a. Karatsuba algorithm .*/
+		 * a.k.a. Karatsuba algorithm. The three products of the top 
+		 * "levels" recursion levels are computed in parallel. */
 		static void karatsubaMultiply(	unsigned char *a, unsigned char *b,
 										unsigned long int n, 
-										unsigned char *buffer);
+										unsigned char *buffer, 
+										unsigned long int levels = 0);
+		/* Multiplies unsigned char[] "a" and "b" using the Karatsuba 
+		 * algorithm, without padding the shorter one to the length of the 
+		 * longer one. "result" gets na + nb digits. */
+		static void blockMultiply(	unsigned char *a, unsigned long int na,
+									unsigned char *b, unsigned long int nb,
+									unsigned char *result);
 		/* Multiplies two unsigned char[] the long way. */
 		static void longMultiply(	unsigned char *a, unsigned long int na,
 									unsigned char *b, unsigned long int nb,
@@ -163,7 +224,26 @@ class BigInt
 		/* Simple subtraction, used by the multiply function. */
 		static void quickSub(	unsigned char *a, unsigned char *b, 
 								unsigned char *end, unsigned long int n);
-		/* Divides two BigInt numbers. */
+		/* Stores the binary representation of "number" into "bits", 
+		 * least significant bit first. */
+		static void toBits(const BigInt &number, std::vector<bool> &bits);
+		/* Stores the binary value of the "count" decimal digits at "digits" 
+		 * into "words". */
+		static void decimalToWords(	const unsigned char *digits, 
+									unsigned long int count, 
+									std::vector<std::uint32_t> &words);
+		/* Returns the value of the "count" 32-bit words at "words". */
+		static BigInt wordsToDecimal(	const std::uint32_t *words, 
+										unsigned long int count);
+		/* Stores the absolute value into "limbs" of nine decimal digits, 
+		 * least significant limb first. */
+		void toLimbs(std::vector<std::uint32_t> &limbs) const;
+		/* Returns the number stored in "limbs" of nine decimal digits, 
+		 * least significant limb first. */
+		static BigInt fromLimbs(const std::vector<std::uint32_t> &limbs);
+		/* Divides two BigInt numbers by the formula 
+		 * |dividend| = |divisor| * quotient + remainder. "remainder" may 
+		 * be "dividend". */
 		static void divide(	const BigInt &dividend, const BigInt &divisor,
 							BigInt &quotient, BigInt &remainder);
 		/* Returns the value of the specified unsigned char[] as long int. */
@@ -183,7 +263,29 @@ class BigInt
 		BigInt &shiftRight(unsigned long int n);
 		/* Expands the digits* to n. */
 		void expandTo(unsigned long int n);
+		/* Returns the lowest 64 bits of the absolute value. */
+		std::uint64_t lowBits() const;
+		/* Compares the absolute value with "number". Returns 0 if they are 
+		 * equal, 1 if the absolute value is greater, 2 if it's less. */
+		int compareWord(unsigned long int number) const;
+		/* Compares "a" with "b". Returns 0 if a == b, 1 if a > b, 
+		 * 2 if a < b. */
+		static int compareWithWord(const BigInt &a, unsigned long int b);
+		/* Adds "number" to the absolute value. */
+		void addWord(unsigned long int number);
+		/* Subtracts "number" from the absolute value, which must not be 
+		 * less than "number". */
+		void subtractWord(unsigned long int number);
+		/* Multiplies the absolute value by "number", which must be at most 
+		 * ULONG_MAX / 10. */
+		void multiplyWord(unsigned long int number);
+		/* Divides the absolute value by "number", which must be at most 
+		 * ULONG_MAX / 10, and returns the remainder. */
+		unsigned long int divideWord(unsigned long int number);
 	public:
+		/* The order of bytes in ToBytes() and FromBytes(): most or least 
+		 * significant byte first. */
+		enum Endian {BIG, LITTLE};
 		BigInt();
 		BigInt(const char *charNum);
 		BigInt(unsigned long int intNum);
@@ -218,6 +320,65 @@ class BigInt
 		BigInt &operator/=(const BigInt &number);
 		friend BigInt operator%(const BigInt &a, const BigInt &b);
 		BigInt &operator%=(const BigInt &number);
+		friend bool operator <(const BigInt &a, unsigned long int b);
+		friend bool operator <(unsigned long int a, const BigInt &b);
+		friend bool operator <=(const BigInt &a, unsigned long int b);
+		friend bool operator <=(unsigned long int a, const BigInt &b);
+		friend bool operator >(const BigInt &a, unsigned long int b);
+		friend bool operator >(unsigned long int a, const BigInt &b);
+		friend bool operator >=(const BigInt &a, unsigned long int b);
+		friend bool operator >=(unsigned long int a, const BigInt &b);
+		friend bool operator ==(const BigInt &a, unsigned long int b);
+		friend bool operator ==(unsigned long int a, const BigInt &b);
+		friend bool operator !=(const BigInt &a, unsigned long int b);
+		friend bool operator !=(unsigned long int a, const BigInt &b);
+		friend BigInt operator+(const BigInt &a, unsigned long int b);
+		friend BigInt operator+(unsigned long int a, const BigInt &b);
+		BigInt &operator+=(unsigned long int number);
+		friend BigInt operator-(const BigInt &a, unsigned long int b);
+		friend BigInt operator-(unsigned long int a, const BigInt &b);
+		BigInt &operator-=(unsigned long int number);
+		friend BigInt operator*(const BigInt &a, unsigned long int b);
+		friend BigInt operator*(unsigned long int a, const BigInt &b);
+		BigInt &operator*=(unsigned long int number);
+		friend BigInt operator/(const BigInt &a, unsigned long int b);
+		BigInt &operator/=(unsigned long int number);
+		friend BigInt operator%(const BigInt &a, unsigned long int b);
+		BigInt &operator%=(unsigned long int number);
+		/* *this = *this / divisor. Returns the remainder of the division 
+		 * of the absolute values. */
+		unsigned long int DivideBy(unsigned long int divisor);
+		/* Returns *this / divisor, where divisor is known to divide *this. 
+		 * If it doesn't, the result is meaningless. */
+		BigInt DivExact(const BigInt &divisor) const;
+		/* Returns |a * b| mod 10^k. Only the lowest k digits of the 
+		 * product are computed. */
+		static BigInt MulLow(	const BigInt &a, const BigInt &b, 
+								unsigned long int k);
+		/* Returns floor(|a * b| / 10^k), or one less. The products of the 
+		 * digits far below the kth are skipped. */
+		static BigInt MulHigh(	const BigInt &a, const BigInt &b, 
+								unsigned long int k);
+		friend BigInt operator<<(const BigInt &a, unsigned long int n);
+		BigInt &operator<<=(unsigned long int n);
+		friend BigInt operator>>(const BigInt &a, unsigned long int n);
+		BigInt &operator>>=(unsigned long int n);
+		friend BigInt operator&(const BigInt &a, const BigInt &b);
+		BigInt &operator&=(const BigInt &number);
+		friend BigInt operator|(const BigInt &a, const BigInt &b);
+		BigInt &operator|=(const BigInt &number);
+		friend BigInt operator^(const BigInt &a, const BigInt &b);
+		BigInt &operator^=(const BigInt &number);
+		/* Returns the number of bits of the absolute value. */
+		unsigned long int BitLength() const;
+		/* Returns the value of the 'index'th bit of the absolute value 
+		 * (zero-based, least significant first). */
+		bool TestBit(unsigned long int index) const;
+		/* Sets the 'index'th bit of the absolute value to 1. */
+		void SetBit(unsigned long int index);
+		/* Returns the number of zero bits below the lowest one bit, 
+		 * or 0 if *this equals 0. */
+		unsigned long int TrailingZeros() const;
 		/* Returns *this to the power of n 
 		 * using the fast Square and Multiply algorithm. */
 		BigInt GetPower(unsigned long int n) const;
@@ -232,6 +393,29 @@ class BigInt
 		BigInt GetPowerMod(const BigInt &b, const BigInt &n) const;
 		/* *this = (*this to the power of b) mod n. */
 		void SetPowerMod(const BigInt &b, const BigInt &n);
+		/* numbers[i] = (numbers[i] to the power of b) mod n, for every i. */
+		static void PowerModBatch(	std::vector<BigInt> &numbers, 
+									const BigInt &b, const BigInt &n);
+		/* Returns the product of (bases[i] to the power of exponents[i]) 
+		 * mod n, for every i. */
+		static BigInt MultiPowMod(	const std::vector<BigInt> &bases, 
+									const std::vector<BigInt> &exponents, 
+									const BigInt &n);
+		/* Stores the absolute value into 32-bit "words", least significant 
+		 * word first, without leading zero words. */
+		void ToWords(std::vector<std::uint32_t> &words) const;
+		/* Returns the number stored in 32-bit "words", least significant 
+		 * word first. */
+		static BigInt FromWords(const std::vector<std::uint32_t> &words);
+		/* Stores the absolute value into "width" bytes at "bytes", in the 
+		 * given byte order, padded with zero bytes. Throws an exception if 
+		 * the number doesn't fit. */
+		void ToBytes(	std::uint8_t *bytes, std::size_t width, 
+						Endian endian = BIG) const;
+		/* Returns the number stored in "count" bytes at "bytes", in the 
+		 * given byte order. */
+		static BigInt FromBytes(const std::uint8_t *bytes, std::size_t count, 
+								Endian endian = BIG);
 		/* Returns the 'index'th digit (zero-based, right-to-left). */
 		unsigned char GetDigit(unsigned long int index) const;
 		/* Sets the value of 'index'th digit 
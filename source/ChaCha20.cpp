@@ -0,0 +1,157 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				ChaCha20.cpp
+ *
+ * This file contains the implementation for the ChaCha20 class.
+ *
+ * ****************************************************************************
+ */
+
+#include "ChaCha20.h"
+
+namespace
+{
+	/* Reads a little-endian 32-bit word from "bytes". */
+	inline std::uint32_t load(const unsigned char *bytes)
+	{
+		return	std::uint32_t(bytes[0]) | std::uint32_t(bytes[1]) << 8 |
+				std::uint32_t(bytes[2]) << 16 | std::uint32_t(bytes[3]) << 24;
+	}
+
+	/* Rotates "word" left by "count" bits. */
+	inline std::uint32_t rotate(std::uint32_t word, int count)
+	{
+		return (word << count) | (word >> (32 - count));
+	}
+
+	/* The ChaCha quarter round on the words "a", "b", "c" and "d" of "x". */
+	inline void quarterRound(std::uint32_t *x, int a, int b, int c, int d)
+	{
+		x[a] += x[b]; x[d] = rotate(x[d] ^ x[a], 16);
+		x[c] += x[d]; x[b] = rotate(x[b] ^ x[c], 12);
+		x[a] += x[b]; x[d] = rotate(x[d] ^ x[a], 8);
+		x[c] += x[d]; x[b] = rotate(x[b] ^ x[c], 7);
+	}
+}
+
+/* Creates a cipher with an all-zero key and nonce. */
+ChaCha20::ChaCha20()
+{
+	const unsigned char zero[KeySize] = {0};
+	*this = ChaCha20(zero, zero);
+}
+
+/* Creates a cipher using "KeySize" bytes at "key" and "NonceSize" bytes
+ * at "nonce", positioned at the beginning of the stream. */
+ChaCha20::ChaCha20(const unsigned char *key, const unsigned char *nonce) :
+	used(sizeof keyStream), exhausted(false)
+{
+	//"expand 32-byte k"
+	state[0] = 0x61707865;
+	state[1] = 0x3320646e;
+	state[2] = 0x79622d32;
+	state[3] = 0x6b206574;
+	for (int i(0); i < 8; i++)
+		state[4 + i] = load(key + 4 * i);
+	state[12] = 0;
+	for (int i(0); i < 3; i++)
+		state[13 + i] = load(nonce + 4 * i);
+}
+
+/* Computes the key stream block for the current block counter and
+ * increments the counter. Throws an exception if the key stream is
+ * used up. */
+void ChaCha20::nextBlock()
+{
+	//a wrapped counter would repeat the key stream from the beginning
+	if (exhausted)
+		throw "Error CHACHA00: The key stream is used up.";
+
+	std::uint32_t x[16];
+	for (int i(0); i < 16; i++)
+		x[i] = state[i];
+	//10 double rounds: 4 column rounds followed by 4 diagonal rounds
+	for (int i(0); i < 10; i++)
+	{
+		quarterRound(x, 0, 4, 8, 12);
+		quarterRound(x, 1, 5, 9, 13);
+		quarterRound(x, 2, 6, 10, 14);
+		quarterRound(x, 3, 7, 11, 15);
+		quarterRound(x, 0, 5, 10, 15);
+		quarterRound(x, 1, 6, 11, 12);
+		quarterRound(x, 2, 7, 8, 13);
+		quarterRound(x, 3, 4, 9, 14);
+	}
+	for (int i(0); i < 16; i++)
+	{
+		const std::uint32_t word(x[i] + state[i]);
+		keyStream[4 * i] = static_cast<unsigned char>(word);
+		keyStream[4 * i + 1] = static_cast<unsigned char>(word >> 8);
+		keyStream[4 * i + 2] = static_cast<unsigned char>(word >> 16);
+		keyStream[4 * i + 3] = static_cast<unsigned char>(word >> 24);
+	}
+	exhausted = ++state[12] == 0;
+	used = 0;
+}
+
+/* Moves to the byte number "offset" of the stream. Throws an exception
+ * if "offset" isn't less than StreamSize. */
+void ChaCha20::Seek(unsigned long long int offset)
+{
+	if (offset >= StreamSize)
+		throw "Error CHACHA01: Offset past the end of the key stream.";
+
+	exhausted = false;
+	state[12] = static_cast<std::uint32_t>(offset / sizeof keyStream);
+	used = sizeof keyStream;
+	if (offset % sizeof keyStream)
+	{
+		nextBlock();
+		used = offset % sizeof keyStream;
+	}
+}
+
+/* Encrypts or decrypts "length" bytes at "input" and stores them at
+ * "output". "input" and "output" may be the same. Throws an exception
+ * if the key stream runs out. */
+void ChaCha20::Process(	const char *input, char *output,
+						unsigned long int length)
+{
+	//finish the current block of the key stream
+	for (; length && used < sizeof keyStream; length--)
+		*output++ = *input++ ^ keyStream[used++];
+
+	//whole blocks
+	for (; length >= sizeof keyStream; length -= sizeof keyStream)
+	{
+		nextBlock();
+		for (unsigned long int i(0); i < sizeof keyStream; i++)
+			output[i] = input[i] ^ keyStream[i];
+		input += sizeof keyStream;
+		output += sizeof keyStream;
+		used = sizeof keyStream;
+	}
+
+	//the beginning of the next block
+	if (length)
+	{
+		nextBlock();
+		for (; length; length--)
+			*output++ = *input++ ^ keyStream[used++];
+	}
+}
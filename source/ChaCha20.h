@@ -0,0 +1,84 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				ChaCha20.h
+ *
+ * An implementation of the ChaCha20 stream cipher, as described in RFC 8439.
+ *
+ * ChaCha20 turns a 256-bit key and a 96-bit nonce into a stream of
+ * pseudorandom bytes (the key stream). Process() XORs data with the key
+ * stream, which both encrypts and decrypts it. The key stream is made of
+ * 64-byte blocks that can be computed independently, so Seek() can move to
+ * any position of the stream in constant time. This lets parts of a long
+ * message be processed in any order.
+ *
+ * The block counter has 32 bits, so the key stream is StreamSize (256 GiB)
+ * long. Seeking past its end, or using it up, throws an exception instead
+ * of starting the key stream over.
+ *
+ * A key and nonce pair must never be used for two different messages.
+ *
+ * NOTE: ChaCha20 only provides confidentiality. It does not detect
+ * 	modifications of the encrypted data.
+ *
+ * ****************************************************************************
+ */
+
+#ifndef CHACHA20_H_
+#define CHACHA20_H_
+
+#include <cstdint>	//uint32_t
+
+class ChaCha20
+{
+	private:
+		/* The cipher state: constants, key, block counter and nonce. */
+		std::uint32_t state[16];
+		/* The current block of the key stream. */
+		unsigned char keyStream[64];
+		/* The number of bytes of "keyStream" already used. */
+		unsigned long int used;
+		/* Set when the block counter has wrapped around. */
+		bool exhausted;
+		/* Computes the key stream block for the current block counter
+		 * and increments the counter. Throws an exception if the key
+		 * stream is used up. */
+		void nextBlock();
+	public:
+		/* The size of a key, in bytes. */
+		static const unsigned long int KeySize = 32;
+		/* The size of a nonce, in bytes. */
+		static const unsigned long int NonceSize = 12;
+		/* The length of the key stream, in bytes. */
+		static const unsigned long long int StreamSize = 64ULL << 32;
+		/* Creates a cipher with an all-zero key and nonce. */
+		ChaCha20();
+		/* Creates a cipher using "KeySize" bytes at "key" and "NonceSize"
+		 * bytes at "nonce", positioned at the beginning of the stream. */
+		ChaCha20(const unsigned char *key, const unsigned char *nonce);
+		/* Moves to the byte number "offset" of the stream. Throws an
+		 * exception if "offset" isn't less than StreamSize. */
+		void Seek(unsigned long long int offset);
+		/* Encrypts or decrypts "length" bytes at "input" and stores them
+		 * at "output". "input" and "output" may be the same. Throws an
+		 * exception if the key stream runs out. */
+		void Process(	const char *input,
+						char *output,
+						unsigned long int length);
+};
+
+#endif /*CHACHA20_H_*/
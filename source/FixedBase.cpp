@@ -0,0 +1,117 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				FixedBase.cpp
+ *
+ * This file contains the implementation for the FixedBase class.
+ *
+ * ****************************************************************************
+ */
+
+#include "FixedBase.h"
+
+/* Prepares the exponentiation of "base" modulo the modulus of "context" to
+ * exponents up to "maxBits" bits long, using a table of at most about
+ * "memoryBudget" bytes. */
+FixedBase::FixedBase(	const std::shared_ptr<const BarrettContext> &context,
+						const BigInt &base,
+						unsigned long int maxBits,
+						unsigned long int memoryBudget) :
+	context(context), base(base), rowCount(0), rowLength(0)
+{
+	if (!context)
+		throw "Error FIXEDBASE00: Missing modulus context.";
+	if (maxBits == 0)
+		throw "Error FIXEDBASE01: The exponent length must be positive.";
+
+	context->Reduce(this->base);
+	precompute(maxBits, memoryBudget);
+}
+
+/* Prepares the exponentiation of "base" modulo "modulus" to exponents up
+ * to "maxBits" bits long, using a table of at most about "memoryBudget"
+ * bytes. */
+FixedBase::FixedBase(	const BigInt &base, const BigInt &modulus,
+						unsigned long int maxBits,
+						unsigned long int memoryBudget) :
+	FixedBase(std::make_shared<const BarrettContext>(modulus), base,
+			maxBits, memoryBudget)
+{}
+
+/* Computes the table. */
+void FixedBase::precompute(	unsigned long int maxBits,
+							unsigned long int memoryBudget)
+{
+	//every number in the table takes about one byte per digit of the
+	//modulus, and there is no point in having more rows than bits
+	const unsigned long int numberSize(context->GetModulus().Length());
+	rowCount = 1;
+	while (rowCount < 16 && rowCount < maxBits &&
+			(2UL << rowCount) * numberSize <= memoryBudget)
+		rowCount++;
+	rowLength = (maxBits + rowCount - 1) / rowCount;
+
+	//table[2^j] = base^(2^(j * d))
+	table.assign(1UL << rowCount, BigIntOne);
+	BigInt power(base);
+	for (unsigned long int j(0); j < rowCount; j++)
+	{
+		if (j > 0)
+			for (unsigned long int i(0); i < rowLength; i++)
+				power = context->Multiply(power, power);
+		table[1UL << j] = power;
+	}
+
+	//every other entry is an entry with one bit less times a power
+	for (unsigned long int i(3); i < table.size(); i++)
+		if (i & (i - 1))
+			table[i] = context->Multiply(table[i & (i - 1)],
+					table[i & ~(i - 1)]);
+}
+
+/* Returns (base to the power of exponent) mod modulus. */
+BigInt FixedBase::PowerMod(const BigInt &exponent) const
+{
+	if (!exponent.IsPositive())
+		throw "Error FIXEDBASE02: Negative exponent not supported.";
+
+	std::vector<bool> bits;
+	BigInt::toBits(exponent, bits);
+	if (bits.size() > rowCount * rowLength)
+		return context->PowerMod(base, exponent);
+	bits.resize(rowCount * rowLength, false);
+
+	//one column of the comb at a time, from the most significant one
+	BigInt result(BigIntOne);
+	bool started(false);
+	for (unsigned long int column(rowLength); column-- > 0; )
+	{
+		if (started)
+			result = context->Multiply(result, result);
+		unsigned long int index(0);
+		for (unsigned long int j(0); j < rowCount; j++)
+			if (bits[j * rowLength + column])
+				index |= 1UL << j;
+		if (index)
+		{
+			result = started ? context->Multiply(result, table[index]) :
+					table[index];
+			started = true;
+		}
+	}
+	return result;
+}
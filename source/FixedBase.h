@@ -0,0 +1,92 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				FixedBase.h
+ *
+ * Modular exponentiation of a fixed base to many different exponents.
+ *
+ * When the same base is raised to many exponents modulo the same n, most
+ * of the squarings done by BigInt::GetPowerMod() can be done once, in
+ * advance. FixedBase uses the comb method of Lim and Lee: the bits of an
+ * exponent up to "maxBits" bits long are written as a table with w rows
+ * of d = ceil(maxBits / w) bits,
+ *
+ * 			e = sum over rows j of (row j) * 2^(j * d)
+ *
+ * and the products of the powers base^(2^(j * d)) for every subset of the
+ * rows are precomputed. After that, an exponentiation needs only d - 1
+ * squarings and at most d multiplications, one per column of the table.
+ * With w = 3 that is a third of the squarings of GetPowerMod().
+ *
+ * The table holds 2^w numbers as long as the modulus. The number of rows
+ * w is the largest one that fits into the given memory budget.
+ *
+ * The results are the same as those of GetPowerMod(): the base is reduced
+ * first, and an exponent of zero gives one. Exponents longer than
+ * "maxBits" bits are allowed, but they are exponentiated the usual way.
+ *
+ * ****************************************************************************
+ */
+
+#ifndef FIXEDBASE_H_
+#define FIXEDBASE_H_
+
+#include "BigInt.h"
+#include "BarrettContext.h"
+#include <vector>	//vector
+#include <memory>	//shared_ptr
+
+class FixedBase
+{
+	private:
+		std::shared_ptr<const BarrettContext> context;
+		/* The base, reduced modulo the modulus. */
+		BigInt base;
+		/* The number of rows of the comb (w). */
+		unsigned long int rowCount;
+		/* The number of bits in a row of the comb (d). */
+		unsigned long int rowLength;
+		/* table[i] is the product of base^(2^(j * d)) for every bit j
+		 * set in i. */
+		std::vector<BigInt> table;
+		/* Computes the table. */
+		void precompute(unsigned long int maxBits,
+						unsigned long int memoryBudget);
+	public:
+		/* Prepares the exponentiation of "base" modulo the modulus of
+		 * "context" to exponents up to "maxBits" bits long, using a table
+		 * of at most about "memoryBudget" bytes. */
+		FixedBase(	const std::shared_ptr<const BarrettContext> &context,
+					const BigInt &base,
+					unsigned long int maxBits,
+					unsigned long int memoryBudget = 1UL << 16);
+		/* Prepares the exponentiation of "base" modulo "modulus" to
+		 * exponents up to "maxBits" bits long, using a table of at most
+		 * about "memoryBudget" bytes. */
+		FixedBase(	const BigInt &base, const BigInt &modulus,
+					unsigned long int maxBits,
+					unsigned long int memoryBudget = 1UL << 16);
+		/* Returns the number of rows of the comb. */
+		unsigned long int GetRowCount() const
+		{
+			return rowCount;
+		}
+		/* Returns (base to the power of exponent) mod modulus. */
+		BigInt PowerMod(const BigInt &exponent) const;
+};
+
+#endif /*FIXEDBASE_H_*/
@@ -27,6 +27,10 @@
  * A public or private RSA key consists of a modulus and an exponent. In this 
  * implementation an object of type BigInt is used to store those values. 
  * 
+ * A private key can also hold the prime factors p and q of the modulus and 
+ * the values derived from them, which let it be used four times faster with 
+ * the Chinese Remainder Theorem (HasCRT()). 
+ * 
  * ****************************************************************************
  */
 
@@ -41,10 +45,26 @@ class Key
 	private:
 		BigInt modulus;
 		BigInt exponent;
+		/* The Chinese Remainder Theorem values, zero if not known. */
+		BigInt p;
+		BigInt q;
+		BigInt dP;
+		BigInt dQ;
+		BigInt qInv;
 	public:
 		Key(const BigInt &modulus, const BigInt &exponent) :
 			modulus(modulus), exponent(exponent)
 		{}
+		/* Creates a private key with the Chinese Remainder Theorem values: 
+		 * "p" and "q" are the prime factors of the modulus, "dP" and "dQ" 
+		 * are the exponent modulo p - 1 and q - 1 and "qInv" is the 
+		 * inverse of q modulo p. */
+		Key(const BigInt &modulus, const BigInt &exponent, 
+			const BigInt &p, const BigInt &q, 
+			const BigInt &dP, const BigInt &dQ, const BigInt &qInv) :
+			modulus(modulus), exponent(exponent), 
+			p(p), q(q), dP(dP), dQ(dQ), qInv(qInv)
+		{}
 		const BigInt &GetModulus() const
 		{
 			return modulus;
@@ -53,6 +73,31 @@ class Key
 		{
 			return exponent;
 		}
+		/* Returns true if the Chinese Remainder Theorem values are known. */
+		bool HasCRT() const
+		{
+			return !p.EqualsZero();
+		}
+		const BigInt &GetP() const
+		{
+			return p;
+		}
+		const BigInt &GetQ() const
+		{
+			return q;
+		}
+		const BigInt &GetDP() const
+		{
+			return dP;
+		}
+		const BigInt &GetDQ() const
+		{
+			return dQ;
+		}
+		const BigInt &GetQInv() const
+		{
+			return qInv;
+		}
 		friend std::ostream &operator<<(std::ostream &cout, const Key &key);
 };
 
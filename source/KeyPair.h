@@ -38,8 +38,8 @@
 class KeyPair
 {
 	private:
-		const Key privateKey;
-		const Key publicKey;
+		Key privateKey;
+		Key publicKey;
 	public:
 		KeyPair(Key privateKey, Key publicKey): 
 			privateKey(privateKey), publicKey(publicKey)
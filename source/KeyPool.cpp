@@ -0,0 +1,194 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				KeyPool.cpp
+ *
+ * This file contains the implementation for the KeyPool class.
+ *
+ * ****************************************************************************
+ */
+
+#include "KeyPool.h"
+#include "RSA.h"	//GenerateKeyPair()
+#if defined(__linux__)
+#include <sys/resource.h>	//setpriority()
+#endif
+
+/* Creates a pool which keeps "depth" keypairs ready for each key
+ * length, and refills them using "threadCount" background threads.
+ * "k" is passed to RSA::GenerateKeyPair(). */
+KeyPool::KeyPool(	unsigned long int depth,
+					unsigned long int threadCount,
+					unsigned long int k) :
+	depth(depth), k(k), generatedCount(0),
+	startTime(std::chrono::steady_clock::now()), stopping(false)
+{
+	if (depth == 0 || threadCount == 0)
+		throw "Error KEYPOOL00: Pool depth and thread count must be positive.";
+
+	for (unsigned long int i(0); i < threadCount; i++)
+		threads.push_back(std::thread(&KeyPool::refill, this));
+}
+
+KeyPool::~KeyPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	refillNeeded.notify_all();
+	//a thread in the middle of key generation stops when it is done
+	for (unsigned long int i(0); i < threads.size(); i++)
+		threads[i].join();
+}
+
+/* Returns the key length that needs a new keypair the most, or 0 if
+ * every key length is full or being filled. Must be called with
+ * "mutex" locked. */
+unsigned long int KeyPool::findEmptiest() const
+{
+	unsigned long int digitCount(0), lowest(depth);
+	std::map<unsigned long int, std::deque<KeyPair> >::const_iterator i;
+	for (i = pool.begin(); i != pool.end(); ++i)
+	{
+		//keypairs being generated count as ready, so that the threads
+		//don't fill a key length past "depth" between them
+		std::map<unsigned long int, unsigned long int>::const_iterator j(
+				pending.find(i->first));
+		const unsigned long int size(i->second.size() +
+				(j == pending.end() ? 0 : j->second));
+		if (size < lowest)
+		{
+			lowest = size;
+			digitCount = i->first;
+		}
+	}
+	return digitCount;
+}
+
+/* The body of the background threads. */
+void KeyPool::refill()
+{
+#if defined(__linux__)
+	//on Linux this lowers the priority of the calling thread only, so that
+	//key generation doesn't compete with the threads serving requests
+	setpriority(PRIO_PROCESS, 0, 19);
+#endif
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping)
+	{
+		unsigned long int digitCount(findEmptiest());
+		if (digitCount == 0)
+		{
+			refillNeeded.wait(lock);
+			continue;
+		}
+
+		//the pool stays usable while the key is being generated
+		pending[digitCount]++;
+		lock.unlock();
+		KeyPair keyPair(RSA::GenerateKeyPair(digitCount, k));
+		lock.lock();
+		pending[digitCount]--;
+
+		pool[digitCount].push_back(keyPair);
+		generatedCount++;
+		keyReady.notify_all();
+	}
+}
+
+/* Starts keeping keypairs "digitCount" digits long ready. */
+void KeyPool::Reserve(unsigned long int digitCount)
+{
+	if (digitCount < 8)
+		throw "Error KEYPOOL01: Keys must be at least 8 digits long.";
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (pool.find(digitCount) != pool.end())
+		return;
+	pool[digitCount];
+	refillNeeded.notify_all();
+}
+
+/* If a keypair "digitCount" digits long is ready, removes it from
+ * the pool, stores it in "keyPair" and returns true. Otherwise
+ * returns false immediately. */
+bool KeyPool::TryAcquire(unsigned long int digitCount, KeyPair &keyPair)
+{
+	Reserve(digitCount);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::deque<KeyPair> &ready(pool[digitCount]);
+	if (ready.empty())
+		return false;
+	keyPair = ready.front();
+	ready.pop_front();
+	refillNeeded.notify_one();
+	return true;
+}
+
+/* Removes a keypair "digitCount" digits long from the pool and
+ * returns it, waiting at most "timeout" milliseconds for one to be
+ * generated. Throws an exception on timeout. */
+KeyPair KeyPool::Acquire(	unsigned long int digitCount,
+							unsigned long int timeout)
+{
+	Reserve(digitCount);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	std::deque<KeyPair> &ready(pool[digitCount]);
+	const std::chrono::steady_clock::time_point deadline(
+			std::chrono::steady_clock::now() +
+			std::chrono::milliseconds(timeout));
+	while (ready.empty())
+		if (keyReady.wait_until(lock, deadline) == std::cv_status::timeout
+			&& ready.empty())
+			throw "Error KEYPOOL02: Timed out waiting for a keypair.";
+
+	KeyPair keyPair(ready.front());
+	ready.pop_front();
+	refillNeeded.notify_one();
+	return keyPair;
+}
+
+/* Returns the number of ready keypairs "digitCount" digits long. */
+unsigned long int KeyPool::GetDepth(unsigned long int digitCount) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<unsigned long int, std::deque<KeyPair> >::const_iterator i(
+			pool.find(digitCount));
+	return i == pool.end() ? 0 : i->second.size();
+}
+
+/* Returns the number of keypairs generated by the pool. */
+unsigned long int KeyPool::GetGeneratedCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return generatedCount;
+}
+
+/* Returns the average number of keypairs generated per second
+ * since the pool was created. */
+double KeyPool::GetRefillRate() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	const std::chrono::duration<double> elapsed(
+			std::chrono::steady_clock::now() - startTime);
+	if (elapsed.count() <= 0.0)
+		return 0.0;
+	return generatedCount / elapsed.count();
+}
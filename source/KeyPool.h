@@ -0,0 +1,119 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				KeyPool.h
+ *
+ * A pool of pregenerated RSA keypairs.
+ *
+ * Generating a keypair takes a long time (see RSA::GenerateKeyPair()), so
+ * a KeyPool keeps up to "depth" ready keypairs for every registered key
+ * length and refills them using background threads. A keypair is handed out
+ * in constant time if one is ready.
+ *
+ * KeyPool supports:
+ *
+ * 	- registering a key length to be kept ready (Reserve())
+ * 	- getting a ready keypair without waiting (TryAcquire())
+ * 	- getting a keypair, waiting for it at most a given time (Acquire())
+ * 	- pool statistics (GetDepth(), GetGeneratedCount(), GetRefillRate())
+ *
+ * Key lengths are given in decimal digits, the same way as for
+ * RSA::GenerateKeyPair(). A key length is registered automatically the first
+ * time a keypair of that length is requested.
+ *
+ * NOTE: Copying and assignment of objects of type KeyPool is forbidden.
+ * 	The background threads are stopped when the pool is destroyed.
+ *
+ * ****************************************************************************
+ */
+
+#ifndef KEYPOOL_H_
+#define KEYPOOL_H_
+
+#include "KeyPair.h"
+#include <map>	//map
+#include <deque>	//deque
+#include <vector>	//vector
+#include <thread>	//thread
+#include <mutex>	//mutex, unique_lock
+#include <condition_variable>	//condition_variable
+#include <chrono>	//steady_clock
+
+class KeyPool
+{
+	private:
+		/* Ready keypairs, by key length. */
+		std::map<unsigned long int, std::deque<KeyPair> > pool;
+		/* The number of keypairs being generated, by key length. */
+		std::map<unsigned long int, unsigned long int> pending;
+		/* The number of keypairs to keep ready for each key length. */
+		const unsigned long int depth;
+		/* Miller-Rabin iteration count used for key generation. */
+		const unsigned long int k;
+		/* The number of keypairs generated since the pool was created. */
+		unsigned long int generatedCount;
+		/* The time when the pool was created. */
+		const std::chrono::steady_clock::time_point startTime;
+		/* Set when the background threads need to stop. */
+		bool stopping;
+		/* Guards all of the above. */
+		mutable std::mutex mutex;
+		/* Signaled when a key length needs refilling or the pool stops. */
+		std::condition_variable refillNeeded;
+		/* Signaled when a new keypair is ready. */
+		std::condition_variable keyReady;
+		/* The background threads. */
+		std::vector<std::thread> threads;
+		/* Copying of objects of type KeyPool is forbidden. */
+		KeyPool(const KeyPool &keyPool);
+		/* Assignment of objects of type KeyPool is forbidden. */
+		KeyPool &operator=(const KeyPool &keyPool);
+		/* Returns the key length that needs a new keypair the most, or 0 if
+		 * every key length is full or being filled. Must be called with
+		 * "mutex" locked. */
+		unsigned long int findEmptiest() const;
+		/* The body of the background threads. */
+		void refill();
+	public:
+		/* Creates a pool which keeps "depth" keypairs ready for each key
+		 * length, and refills them using "threadCount" background threads.
+		 * "k" is passed to RSA::GenerateKeyPair(). */
+		KeyPool(unsigned long int depth = 4,
+				unsigned long int threadCount = 1,
+				unsigned long int k = 3);
+		~KeyPool();
+		/* Starts keeping keypairs "digitCount" digits long ready. */
+		void Reserve(unsigned long int digitCount);
+		/* If a keypair "digitCount" digits long is ready, removes it from
+		 * the pool, stores it in "keyPair" and returns true. Otherwise
+		 * returns false immediately. */
+		bool TryAcquire(unsigned long int digitCount, KeyPair &keyPair);
+		/* Removes a keypair "digitCount" digits long from the pool and
+		 * returns it, waiting at most "timeout" milliseconds for one to be
+		 * generated. Throws an exception on timeout. */
+		KeyPair Acquire(unsigned long int digitCount,
+						unsigned long int timeout);
+		/* Returns the number of ready keypairs "digitCount" digits long. */
+		unsigned long int GetDepth(unsigned long int digitCount) const;
+		/* Returns the number of keypairs generated by the pool. */
+		unsigned long int GetGeneratedCount() const;
+		/* Returns the average number of keypairs generated per second
+		 * since the pool was created. */
+		double GetRefillRate() const;
+};
+
+#endif /*KEYPOOL_H_*/
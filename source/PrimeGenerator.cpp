@@ -24,19 +24,30 @@
  * 
  * This file contains the implementation for the PrimeGenerator class.
  * 
- * There is a static constant defined in this file: 
- * 
- * - RandMax		: RAND_MAX (defined in cstdlib) of type BigInt
- * 		Mainly used for speedup in the Generate member function. 
- * 		Represents the largest random unsigned long integer that a particular 
- * 		platform can generate. This is platform-specific. 
- * 	 
  * ****************************************************************************
  */
 
 #include "PrimeGenerator.h"
 #include <string>
-#include <cstdlib> // rand()
+#include <memory> // make_shared()
+#include <random> // random_device, seed_seq, mt19937
+
+/* Returns a new random number generator, seeded from std::random_device. */
+static std::mt19937 newRandomEngine()
+{
+	std::random_device device;
+	std::seed_seq seed{	device(), device(), device(), device(), 
+						device(), device(), device(), device()};
+	return std::mt19937(seed);
+}
+
+/* Returns a random number. Every thread has its own generator, so the 
+ * background threads of a KeyPool don't share state. */
+static unsigned long int randomNumber()
+{
+	thread_local std::mt19937 engine(newRandomEngine());
+	return engine();
+}
 
 /* Generates a random number with digitCount digits.
  * Returns it by reference in the "number" parameter. */
@@ -51,10 +62,10 @@ void PrimeGenerator::MakeRandom(BigInt &number, unsigned long int digitCount)
 	//generate random digits
 	while (tempDigitCount < digitCount)
 	{
-		unsigned long int newRand(std::rand());
+		unsigned long int newRand(randomNumber());
 
 		//10 is chosen to skip the first digit, because it might be 
-		//statistically <= n, where n is the first digit of RAND_MAX
+		//statistically <= n, where n is the first digit of 2^32 - 1
 		while (newRand >= 10)
 		{
 			newNum[tempDigitCount++] = (newRand % 10) + '0';
@@ -66,7 +77,7 @@ void PrimeGenerator::MakeRandom(BigInt &number, unsigned long int digitCount)
 
 	//make sure the leading digit is not zero
 	if (newNum[0] == '0')
-		newNum[0] = (std::rand() % 9) + 1 + '0';
+		newNum[0] = (randomNumber() % 9) + 1 + '0';
 	number = newNum;
 }
 
@@ -75,7 +86,7 @@ void PrimeGenerator::MakeRandom(BigInt &number, unsigned long int digitCount)
 void PrimeGenerator::makeRandom(BigInt &number, const BigInt &top)
 {
 	//randomly select the number of digits for the random number
-	unsigned long int newDigitCount = (rand() % top.Length()) + 1;
+	unsigned long int newDigitCount = (randomNumber() % top.Length()) + 1;
 	MakeRandom(number, newDigitCount);
 	//make sure number < top
 	while (number >= top)
@@ -93,7 +104,7 @@ void PrimeGenerator::makePrimeCandidate(BigInt &number,
 		number.SetDigit(0, number.GetDigit(0) + 1);
 	//make sure the leading digit is not a zero
 	if (number.GetDigit(number.Length() - 1) == 0)
-		number.SetDigit(number.Length() - 1, (std::rand() % 9) + 1);
+		number.SetDigit(number.Length() - 1, (randomNumber() % 9) + 1);
 }
 
 /* Tests the primality of the given _odd_ number using the 
@@ -105,72 +116,53 @@ bool PrimeGenerator::isProbablePrime(	const BigInt &number,
 {
 	//first we need to calculate such a and b, that
 	//number - 1 = 2^a * b, a and b are integers, b is odd
-	BigInt numberMinusOne(number - BigIntOne);
-	unsigned long int a(0);
-	BigInt temp(numberMinusOne);
-	BigInt b, quotient;
-	static const BigInt two(BigIntOne + BigIntOne);
-
-	while (b.EqualsZero())
-	{
-		//temp = quotient * 2 + remainder
-		
-		//PrimeGenerator used to be a friend of BigInt, so the following 
-		//statement produced the result in one call to BigInt::divide()
-//		BigInt::divide(temp, two, quotient, b);
-		//That doesn't work any more, so we have to use two calls
-		quotient = temp / two;
-		b = temp % two;
-		temp = quotient;
-		a++;
-	}
-	b = temp * two + b;
-	a--;
-
+	const BigInt numberMinusOne(number - 1UL);
+	const unsigned long int a(numberMinusOne.TrailingZeros());
+	const BigInt b(numberMinusOne >> a);
+	BigInt temp;
+
+	//all the witnesses are residues modulo the same number
+	const std::shared_ptr<const BarrettContext> context(
+			std::make_shared<const BarrettContext>(number));
+	const Residue one(context, BigIntOne), minusOne(context, numberMinusOne);
+	
 	//test with k different possible witnesses to ensure that the probability
 	//that "number" is prime is at least 1 - 4^(-k)
 	for (unsigned long int i = 0; i < k; i++)
 	{
 		PrimeGenerator::makeRandom(temp, number);
 		
-		if (isWitness(temp, number, b, a, numberMinusOne))
+		if (isWitness(Residue(context, temp), b, a, one, minusOne))
 			return false; //definitely a composite number
 	}
 	return true; //a probable prime
 }
 
 /* Returns true if "candidate" is a witness for the compositeness
- * of "number", false if "candidate" is a strong liar. "exponent" 
- * and "squareCount" are used for computation */
-bool PrimeGenerator::isWitness(	BigInt candidate, 
-								const BigInt &number, 
+ * of its modulus, false if "candidate" is a strong liar. "exponent" 
+ * and "squareCount" are used for computation, "one" and "minusOne" 
+ * are 1 and -1 modulo the same number. */
+bool PrimeGenerator::isWitness(	Residue candidate, 
 								const BigInt &exponent, 
 								unsigned long int squareCount, 
-								const BigInt &numberMinusOne)
+								const Residue &one, 
+								const Residue &minusOne)
 {
 	//calculate candidate = (candidate to the power of exponent) mod number
-	candidate.SetPowerMod(exponent, number);
-	//temporary variable, used to call the divide function
-	BigInt quotient;
+	candidate = candidate.Power(exponent);
 
 	for (unsigned long int i = 0; i < squareCount; i++)
 	{
 		bool maybeWitness(false);
-		if (candidate != BigIntOne && candidate != numberMinusOne)
+		if (candidate != one && candidate != minusOne)
 			maybeWitness = true;
 
-		//PrimeGenerator used to be a friend of BigInt, so the following 
-		//statement produced the result in one call to BigInt::divide()
-//		BigInt::divide(candidate * candidate, number, quotient, candidate);
-		//That doesn't work any more, so we have to use two calls
 		candidate = candidate * candidate;
-		quotient = (candidate) / number;
-		candidate = (candidate) % number;
-		if (maybeWitness && candidate == BigIntOne)
+		if (maybeWitness && candidate == one)
 			return true; //definitely a composite number
 	}
 
-	if (candidate != BigIntOne)
+	if (candidate != one)
 		return true; //definitely a composite number
 
 	return false; //probable prime
@@ -190,7 +182,7 @@ BigInt PrimeGenerator::Generate(unsigned long int digitCount,
 	while (!isProbablePrime(primeCandidate, k))
 	{
 		//select the next odd number and try again
-		primeCandidate = primeCandidate + 2;
+		primeCandidate += 2UL;
 		if (primeCandidate.Length() != digitCount)
 		PrimeGenerator::makePrimeCandidate(primeCandidate, digitCount);
 	}
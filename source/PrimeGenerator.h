@@ -31,6 +31,7 @@
 #define PRIMEGENERATOR_H_
 
 #include "BigInt.h"
+#include "Residue.h"
 
 class PrimeGenerator
 {
@@ -50,13 +51,14 @@ class PrimeGenerator
 		static bool isProbablePrime(const BigInt &number, 
 									unsigned long int k);
 		/* Returns true if "candidate" is a witness for the compositeness
-		 * of "number", false if "candidate" is a strong liar. "exponent" 
-		 * and "squareCount" are used for computation */
-		static bool isWitness(	BigInt candidate, 
-								const BigInt &number, 
+		 * of its modulus, false if "candidate" is a strong liar. 
+		 * "exponent" and "squareCount" are used for computation, "one" 
+		 * and "minusOne" are 1 and -1 modulo the same number. */
+		static bool isWitness(	Residue candidate, 
 								const BigInt &exponent, 
 								unsigned long int squareCount, 
-								const BigInt &numberMinusOne);
+								const Residue &one, 
+								const Residue &minusOne);
 	public:
 		/* Generates a random number with digitCount digits.
 		 * Returns it by reference in the "number" parameter. */
@@ -31,11 +31,319 @@
 #include "Key.h"	//Key
 #include "KeyPair.h"	//KeyPair
 #include "PrimeGenerator.h"	//Generate()
+#include "ThreadPool.h"	//ThreadPool
+#include "ChaCha20.h"	//ChaCha20
+#include "SHA256.h"	//SHA256
+#include "Residue.h"	//Residue
 #include <string>	//string
 #include <fstream>	//ifstream, ofstream
+#include <functional>	//function
+#include <algorithm>	//copy()
+#include <deque>	//deque
+#include <thread>	//thread
+#include <mutex>	//mutex
+#include <condition_variable>	//condition_variable
+#include <exception>	//exception_ptr
+#include <cstring>	//memchr()
+#include <random>	//random_device
+#include <cstdint>	//uint32_t
+
+//POSIX platforms map the source file into memory and gather the writes to 
+//the destination file, other platforms use the standard file streams
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#define POSIX_IO
+#endif
+
+#ifdef POSIX_IO
+#include <fcntl.h>	//open()
+#include <unistd.h>	//read(), close()
+#include <sys/mman.h>	//mmap(), madvise()
+#include <sys/stat.h>	//fstat()
+#include <sys/uio.h>	//writev()
+#include <cerrno>	//errno
+#include <climits>	//IOV_MAX
+#endif
 
 using std::string;
 
+//define and initialize RSA::parallelThreshold
+std::atomic<unsigned long int> RSA::parallelThreshold(4);
+//define and initialize RSA::pipelineDepth
+std::atomic<unsigned long int> RSA::pipelineDepth(16);
+
+//BINARY files begin with binaryMagic, binaryVersion and the chunk width; 
+//version 1 files use the same encoding as TEXT files, version 2 files are 
+//encoded using RSA::encodePacked()
+static const char binaryMagic[] = "RSAB";
+static const char binaryVersion(2);
+static const unsigned long int binaryHeaderSize(sizeof binaryMagic + 4);
+//HYBRID files have the same header with hybridVersion, followed by the 
+//encrypted session key
+static const char hybridVersion(3);
+//a session key is a ChaCha20 key followed by a nonce
+static const unsigned long int sessionKeySize(
+		ChaCha20::KeySize + ChaCha20::NonceSize);
+//the DER encoding of the SHA-256 algorithm identifier, which is put in front 
+//of a digest when it is signed (see RFC 8017, section 9.2)
+static const unsigned char digestInfo[] = {
+		0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 
+		0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20};
+
+namespace
+{
+	/* A block of a file on its way through RSA::processFile(). The input 
+	 * is "length" bytes at "data", which points either into the mapped 
+	 * source file or into "input", and starts "offset" bytes after the 
+	 * header. The strings keep their memory when the block is reused. */
+	struct Block
+	{
+		unsigned long int index;
+		unsigned long long int offset;
+		const char *data;
+		unsigned long int length;
+		std::string input;
+		std::string output;
+	};
+	
+	/* A file read by RSA::processFile(). Regular files are mapped into 
+	 * memory if the platform allows it (GetData() returns the contents), 
+	 * anything else, like a pipe, is read in portions (Read()). */
+	class SourceFile
+	{
+		private:
+#ifdef POSIX_IO
+			int file;
+#else
+			std::ifstream file;
+#endif
+			const char *data;
+			unsigned long int size;
+			SourceFile(const SourceFile &sourceFile);
+			SourceFile &operator=(const SourceFile &sourceFile);
+		public:
+			explicit SourceFile(const char *name);
+			~SourceFile();
+			bool IsOpen() const;
+			/* Returns the contents of the file, or 0 if it isn't mapped. */
+			const char *GetData() const
+			{
+				return data;
+			}
+			/* Returns the size of a mapped file. */
+			unsigned long int GetSize() const
+			{
+				return size;
+			}
+			/* Reads at most "length" bytes into "buffer". Returns the 
+			 * number of bytes read, 0 at the end of the file. */
+			unsigned long int Read(char *buffer, unsigned long int length);
+	};
+	
+	/* A file written by RSA::processFile(). */
+	class DestFile
+	{
+		private:
+#ifdef POSIX_IO
+			int file;
+#else
+			std::ofstream file;
+#endif
+			DestFile(const DestFile &destFile);
+			DestFile &operator=(const DestFile &destFile);
+		public:
+			explicit DestFile(const char *name);
+			~DestFile();
+			bool IsOpen() const;
+			/* Writes the outputs of "blocks", one after another. */
+			void Write(const std::vector<Block *> &blocks);
+			/* Writes "data". */
+			void Write(const std::string &data);
+	};
+	
+#ifdef POSIX_IO
+	SourceFile::SourceFile(const char *name) : data(0), size(0)
+	{
+		file = open(name, O_RDONLY);
+		struct stat status;
+		if (file < 0 || fstat(file, &status) != 0 || 
+			!S_ISREG(status.st_mode) || status.st_size == 0)
+			return;
+		void *mapped(mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, file, 0));
+		if (mapped == MAP_FAILED)
+			return;
+		//the file is read once, from the beginning to the end
+		madvise(mapped, status.st_size, MADV_SEQUENTIAL);
+		data = static_cast<const char *>(mapped);
+		size = status.st_size;
+	}
+	
+	SourceFile::~SourceFile()
+	{
+		if (data)
+			munmap(const_cast<char *>(data), size);
+		if (file >= 0)
+			close(file);
+	}
+	
+	bool SourceFile::IsOpen() const
+	{
+		return file >= 0;
+	}
+	
+	unsigned long int SourceFile::Read(char *buffer, unsigned long int length)
+	{
+		ssize_t readLength;
+		while ((readLength = read(file, buffer, length)) < 0)
+			if (errno != EINTR)
+				throw "Error RSA04: Bad file?";
+		return readLength;
+	}
+	
+	DestFile::DestFile(const char *name)
+	{
+		file = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	}
+	
+	DestFile::~DestFile()
+	{
+		if (file >= 0)
+			close(file);
+	}
+	
+	bool DestFile::IsOpen() const
+	{
+		return file >= 0;
+	}
+	
+	void DestFile::Write(const std::string &data)
+	{
+		Block block;
+		block.output = data;
+		Write(std::vector<Block *>(1, &block));
+	}
+	
+	void DestFile::Write(const std::vector<Block *> &blocks)
+	{
+		//one system call writes many blocks, straight from their memory
+		std::vector<struct iovec> parts(blocks.size());
+		for (unsigned long int i(0); i < blocks.size(); i++)
+		{
+			parts[i].iov_base = const_cast<char *>(blocks[i]->output.data());
+			parts[i].iov_len = blocks[i]->output.length();
+		}
+		unsigned long int first(0);
+		while (first < parts.size())
+		{
+			unsigned long int count(parts.size() - first);
+			if (count > IOV_MAX)
+				count = IOV_MAX;
+			ssize_t written(writev(file, &parts[first], count));
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written < 0)
+				throw "Error RSA04: Bad file?";
+			//skip what was written, the last part may be written partially
+			for (; first < parts.size() && 
+					static_cast<size_t>(written) >= parts[first].iov_len; first++)
+				written -= parts[first].iov_len;
+			if (written)
+			{
+				parts[first].iov_base = 
+						static_cast<char *>(parts[first].iov_base) + written;
+				parts[first].iov_len -= written;
+			}
+		}
+	}
+#else
+	SourceFile::SourceFile(const char *name) : 
+		file(name, std::ios::in | std::ios::binary), data(0), size(0)
+	{}
+	
+	SourceFile::~SourceFile()
+	{}
+	
+	bool SourceFile::IsOpen() const
+	{
+		return file.is_open();
+	}
+	
+	unsigned long int SourceFile::Read(char *buffer, unsigned long int length)
+	{
+		file.read(buffer, length);
+		if (file.bad())
+			throw "Error RSA04: Bad file?";
+		return file.gcount();
+	}
+	
+	DestFile::DestFile(const char *name) : 
+		file(name, std::ios::out | std::ios::binary)
+	{}
+	
+	DestFile::~DestFile()
+	{}
+	
+	bool DestFile::IsOpen() const
+	{
+		return file.is_open();
+	}
+	
+	void DestFile::Write(const std::string &data)
+	{
+		file.write(data.data(), data.length());
+		if (!file)
+			throw "Error RSA04: Bad file?";
+	}
+	
+	void DestFile::Write(const std::vector<Block *> &blocks)
+	{
+		for (unsigned long int i(0); i < blocks.size(); i++)
+		{
+			file.write(blocks[i]->output.data(), blocks[i]->output.length());
+			if (!file)
+				throw "Error RSA04: Bad file?";
+		}
+	}
+#endif
+	
+	/* A queue of blocks passed between the stages of RSA::processFile(). 
+	 * Pop() waits for a block, and returns 0 once the queue is closed 
+	 * and empty. */
+	class BlockQueue
+	{
+		private:
+			std::deque<Block *> blocks;
+			bool closed;
+			std::mutex mutex;
+			std::condition_variable pushed;
+		public:
+			BlockQueue() : closed(false)
+			{}
+			void Push(Block *block)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				blocks.push_back(block);
+				pushed.notify_one();
+			}
+			Block *Pop()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				while (blocks.empty() && !closed)
+					pushed.wait(lock);
+				if (blocks.empty())
+					return 0;
+				Block *block(blocks.front());
+				blocks.pop_front();
+				return block;
+			}
+			void Close()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				closed = true;
+				pushed.notify_all();
+			}
+	};
+}
+
 /* Returns the greatest common divisor of the two arguments 
  * "a" and "b", using the Euclidean algorithm. */
 BigInt RSA::GCD(const BigInt &a, const BigInt &b)
@@ -76,7 +384,7 @@ BigInt RSA::solveModularLinearEquation(	const BigInt &a,
 	BigInt p, q, r;
 	RSA::extendedEuclideanAlgorithm(a, n, p, q, r);
 	if ((b % p).EqualsZero())	// This has to evaluate to 'true'.
-		return (q * (b / p)) % n;
+		return (q * b.DivExact(p)) % n;
 	else
 		throw "Error RSA00: Error in key generation."; // Detect mistakes.
 }
@@ -137,71 +445,307 @@ string RSA::decode(const BigInt &message)
 	return decoded;
 }
 
-/* Encrypts a "chunk" (a small part of a message) using "key" */
-string RSA::encryptChunk(const string &chunk, const Key &key)
+/* Transforms "length" bytes of a message at "message" into a BigInt 
+ * message. The bytes are the digits of a base 256 number, the first one 
+ * being the most significant. Like in RSA::encode(), a special byte 1 is 
+ * put in front of the message, so that leading zero bytes aren't lost. */
+BigInt RSA::encodePacked(const char *message, unsigned long int length)
 {
-	// First encode the chunk, to make sure it is represented as an integer. 
-	BigInt a = RSA::encode(chunk);
-	// The RSA encryption algorithm is a congruence equation. 
-	a.SetPowerMod(key.GetExponent(), key.GetModulus());
-	return a.ToString();
+	std::vector<unsigned char> bytes(length + 1, 1);
+	std::copy(message, message + length, bytes.begin() + 1);
+	return BigInt::FromBytes(&bytes[0], bytes.size());
 }
 
-/* Decrypts a "chunk" (a small part of a message) using "key" */
-string RSA::decryptChunk(const BigInt &chunk, const Key &key)
+/* Transforms a BigInt message encoded using RSA::encodePacked() back 
+ * into a std::string message. */
+string RSA::decodePacked(const BigInt &message)
 {
-	BigInt a = chunk;
-	// The RSA decryption algorithm is a congruence equation. 
-	a.SetPowerMod(key.GetExponent(), key.GetModulus());
-	// Decode the message to a readable form. 
-	return RSA::decode(a);
+	std::vector<unsigned char> bytes(RSA::byteLength(message));
+	if (bytes.empty())
+		throw "Error RSA05: File contains unexpected data.";
+	message.ToBytes(&bytes[0], bytes.size());
+	// Skip the special byte 1. 
+	if (bytes[0] != 1)
+		throw "Error RSA05: File contains unexpected data.";
+	return string(bytes.begin() + 1, bytes.end());
+}
+
+/* Returns the number of bytes needed to store "number". */
+unsigned long int RSA::byteLength(const BigInt &number)
+{
+	std::vector<std::uint32_t> words;
+	number.ToWords(words);
+	if (words.empty())
+		return 0;
+	// ToWords() leaves out the leading zero words. 
+	unsigned long int length(4 * (words.size() - 1));
+	for (std::uint32_t top(words.back()); top; top >>= 8)
+		length++;
+	return length;
+}
+
+/* Returns the header of a BINARY or HYBRID file with chunks "chunkWidth" 
+ * bytes long. */
+string RSA::binaryHeader(unsigned long int chunkWidth, bool hybrid)
+{
+	string header(binaryMagic, sizeof binaryMagic - 1);
+	header.push_back(hybrid ? hybridVersion : binaryVersion);
+	for (int i(3); i >= 0; i--)
+		header.push_back(char((chunkWidth >> (i * 8)) & 0xFF));
+	return header;
+}
+
+/* Returns the chunk width stored in the header at the beginning of a 
+ * BINARY or HYBRID file, "length" bytes of which are at "data", and the 
+ * version of the file format in "version". Returns 0 for a TEXT file. 
+ * Throws an exception if the file can't be decrypted using "key". */
+unsigned long int RSA::readHeader(	const char *data, unsigned long int length, 
+									const Key &key, char &version)
+{
+	version = 0;
+	if (length < sizeof binaryMagic - 1 || 
+		std::memcmp(data, binaryMagic, sizeof binaryMagic - 1) != 0)
+		return 0;
+	if (length < binaryHeaderSize)
+		RSA::fileError(true, false);
+	if (data[4] != 1 && data[4] != binaryVersion && data[4] != hybridVersion)
+		throw "Error RSA12: Unsupported file format version.";
+	version = data[4];
+	
+	unsigned long int chunkWidth(0);
+	for (int i(5); i < 9; i++)
+		chunkWidth = (chunkWidth << 8) | static_cast<unsigned char>(data[i]);
+	if (chunkWidth != RSA::byteLength(key.GetModulus()))
+		throw "Error RSA13: The file was encrypted using a different key.";
+	return chunkWidth;
+}
+
+/* Returns a new random session key. */
+string RSA::newSessionKey()
+{
+	std::random_device random;
+	string sessionKey;
+	while (sessionKey.length() < sessionKeySize)
+	{
+		const unsigned int word(random());
+		for (unsigned long int i(0); i < sizeof word && 
+				sessionKey.length() < sessionKeySize; i++)
+			sessionKey.push_back(char(word >> (i * 8)));
+	}
+	return sessionKey;
+}
+
+/* Returns the size of a session key encrypted into chunks "chunkWidth" 
+ * bytes long. */
+unsigned long int RSA::sessionKeyWidth(unsigned long int chunkWidth)
+{
+	// The session key is packed, see RSA::chunkSize(). 
+	const unsigned long int chunkSize(chunkWidth - 2);
+	return (sessionKeySize + chunkSize - 1) / chunkSize * chunkWidth;
+}
+
+/* Returns a ChaCha20 cipher using "sessionKey". */
+ChaCha20 RSA::sessionCipher(const string &sessionKey)
+{
+	const unsigned char *bytes(
+			reinterpret_cast<const unsigned char *>(sessionKey.data()));
+	return ChaCha20(bytes, bytes + ChaCha20::KeySize);
+}
+
+/* Returns the session key encrypted at "data" using "key" into chunks 
+ * "chunkWidth" bytes long. */
+string RSA::readSessionKey(	const char *data, unsigned long int chunkWidth, 
+							const Key &key)
+{
+	const string sessionKey(RSA::decryptString(	data, 
+												RSA::sessionKeyWidth(chunkWidth), 
+												key, true, chunkWidth, true));
+	if (sessionKey.length() != sessionKeySize)
+		throw "Error RSA05: File contains unexpected data.";
+	return sessionKey;
+}
+
+/* Raises every chunk of "chunks" to the power of the exponent of "key", 
+ * modulo the modulus of "key", in the calling thread. */
+void RSA::exponentiate(std::vector<BigInt> &chunks, const Key &key)
+{
+	const BigInt &n(key.GetModulus());
+	if (key.HasCRT())
+	{
+		// Exponentiate modulo p and q, which are half as long as n, and 
+		// combine the results using Garner's formula. 
+		const std::shared_ptr<const BarrettContext> p(
+				std::make_shared<const BarrettContext>(key.GetP()));
+		const BarrettContext q(key.GetQ());
+		std::vector<BigInt> modP(chunks), modQ(chunks);
+		p->PowerModBatch(modP, key.GetDP());
+		q.PowerModBatch(modQ, key.GetDQ());
+		const Residue qInv(p, key.GetQInv());
+		for (unsigned long int i(0); i < chunks.size(); i++)
+		{
+			// h = qInv * (m1 - m2) mod p 
+			const Residue h((Residue(p, modP[i]) - Residue(p, modQ[i])) * qInv);
+			chunks[i] = modQ[i] + h.GetValue() * q.GetModulus();
+		}
+	}
+	else
+		// The exponent 65537 is recognized by BigInt::PowerModBatch(). 
+		BigInt::PowerModBatch(chunks, key.GetExponent(), n);
+}
+
+/* Raises every "chunk" (an encoded part of a message) to the power 
+ * of the exponent of "key", modulo the modulus of "key". This is 
+ * both RSA encryption and RSA decryption. */
+void RSA::powerModChunks(	std::vector<BigInt> &chunks, const Key &key, 
+							bool parallel)
+{
+	// The RSA encryption and decryption algorithms are congruence equations. 
+	// All the chunks use the same key, so they are exponentiated together. 
+	ThreadPool &pool(ThreadPool::GetDefault());
+	const unsigned long int threshold(RSA::parallelThreshold);
+	if (!parallel || threshold == 0 || chunks.size() < threshold || 
+		pool.GetThreadCount() == 1)
+	{
+		RSA::exponentiate(chunks, key);
+		return;
+	}
+	
+	// Give every thread a part of the chunks, in order. 
+	unsigned long int partCount(pool.GetThreadCount());
+	if (partCount > chunks.size())
+		partCount = chunks.size();
+	std::vector<std::function<void()> > tasks;
+	for (unsigned long int i(0); i < partCount; i++)
+	{
+		const unsigned long int begin(chunks.size() * i / partCount);
+		const unsigned long int end(chunks.size() * (i + 1) / partCount);
+		tasks.push_back([&chunks, &key, begin, end]()
+		{
+			std::vector<BigInt> part(chunks.begin() + begin, 
+									chunks.begin() + end);
+			RSA::exponentiate(part, key);
+			std::copy(part.begin(), part.end(), chunks.begin() + begin);
+		});
+	}
+	pool.Run(tasks);
+}
+
+/* Messages of at least "chunkCount" chunks will be encrypted and 
+ * decrypted in parallel. Zero turns parallel processing off. */
+void RSA::SetParallelThreshold(unsigned long int chunkCount)
+{
+	RSA::parallelThreshold = chunkCount;
+}
+
+/* Files are encrypted and decrypted using at most "blockCount" 
+ * blocks of memory, a few kilobytes each. One thread reads the 
+ * blocks, the threads of ThreadPool::GetDefault() encrypt or 
+ * decrypt them and one thread writes them, in order. */
+void RSA::SetPipelineDepth(unsigned long int blockCount)
+{
+	RSA::pipelineDepth = blockCount;
+}
+
+/* Returns the number of message bytes that fit into one chunk encrypted 
+ * using "key", when the chunk is encoded using RSA::encodePacked() if 
+ * "packed" is true, or RSA::encode() otherwise. */
+unsigned long int RSA::chunkSize(const Key &key, bool packed)
+{
+	if (!packed)
+		return (key.GetModulus().Length() - 2) / 3;
+	// The modulus is at least 256^(byteLength - 1), and the encoded chunk 
+	// with the special byte is less than 2 * 256^chunkSize. 
+	return RSA::byteLength(key.GetModulus()) - 2;
 }
 
 /* Encrypts a string "message" using "key". */
-std::string RSA::encryptString(const std::string &message, const Key &key)
+std::string RSA::encryptString(	const char *message, unsigned long int length, 
+								const Key &key, bool parallel, 
+								unsigned long int chunkWidth)
 {
 	//partition the message into biggest possible encryptable chunks
-	const unsigned long int chunkSize(((key.GetModulus().Length() - 2) / 3));
-	const unsigned long int chunkCount = message.length() / chunkSize;
+	const unsigned long int chunkSize(RSA::chunkSize(key, chunkWidth != 0));
+	// The last chunk may be smaller than the others. 
+	const unsigned long int chunkCount = (length + chunkSize - 1) / chunkSize;
+	
+	// First encode the chunks, to make sure they are represented as integers. 
+	// Binary chunks are packed, text chunks are encoded the old way so that 
+	// older versions can still decrypt them. 
+	std::vector<BigInt> chunks;
+	chunks.reserve(chunkCount);
+	for (unsigned long int i(0); i < chunkCount; i++)
+	{
+		const unsigned long int offset(i * chunkSize);
+		const unsigned long int size(
+				length - offset < chunkSize ? length - offset : chunkSize);
+		if (chunkWidth)
+			chunks.push_back(RSA::encodePacked(message + offset, size));
+		else
+			chunks.push_back(RSA::encode(string(message + offset, size)));
+	}
+	
+	RSA::powerModChunks(chunks, key, parallel);
 	
 	string cypherText;
+	if (chunkWidth)
+	{
+		// Binary chunks all have the same width, so they don't need to 
+		// be separated. 
+		cypherText.resize(chunkCount * chunkWidth);
+		for (unsigned long int i(0); i < chunkCount; i++)
+			chunks[i].ToBytes(
+				reinterpret_cast<unsigned char *>(&cypherText[i * chunkWidth]), 
+				chunkWidth);
+		return cypherText;
+	}
 	for (unsigned long int i(0); i < chunkCount; i++)
 	{
-		// Get the next chunk.
-		string chunk(message.substr(i * chunkSize, chunkSize));
-		chunk = RSA::encryptChunk(chunk, key);
 		// Put a ' ' between the chunks so that we can separate them later. 
-		cypherText.append(chunk.append(" "));
+		cypherText.append(chunks[i].ToString());
+		cypherText.push_back(' ');
 	}
-	// If the last chunk has the same size as the others, we are finished. 
-	if (chunkSize * chunkCount == message.length())
-		return cypherText;
-	
-	// Handle the last chunk. It is smaller than the others. 
-	const unsigned long int lastChunkSize = message.length() % chunkSize;
-	string lastChunk(message.substr(chunkCount * chunkSize, lastChunkSize));
-	lastChunk = RSA::encryptChunk(lastChunk, key);
-	return cypherText.append(lastChunk.append(" "));
+	return cypherText;
 }
 
 /* Decrypts a string "message" using "key". */
-std::string RSA::decryptString(const std::string &cypherText, const Key &key)
+std::string RSA::decryptString(	const char *cypherText, unsigned long int length, 
+								const Key &key, bool parallel, 
+								unsigned long int chunkWidth, bool packed)
 {
-	// Partition the cypherText into chunks. They are seperated by ' '. 
-	string message;
-	long int i(0), j(0);
-	while ((j = cypherText.find(' ', i)) != -1)
+	std::vector<BigInt> chunks;
+	const char *end(cypherText + length), *space;
+	if (chunkWidth)
 	{
-		// Get the chunk. 
-		BigInt chunk(cypherText.substr(i, j - i));
-		if (chunk >= key.GetModulus())
-			throw "Error RSA02: Chunk too large.";
-		
-		// Decrypt the chunk and store the message. 
-		string text = RSA::decryptChunk(chunk, key);
-		message.append(text);
-		i = j + 1;
+		// Binary chunks all have the same width. 
+		if (length % chunkWidth)
+			throw "Error RSA05: File contains unexpected data.";
+		for (; cypherText < end; cypherText += chunkWidth)
+			chunks.push_back(BigInt::FromBytes(
+					reinterpret_cast<const unsigned char *>(cypherText), 
+					chunkWidth));
 	}
+	else
+		// Partition the cypherText into chunks. They are seperated by ' '. 
+		while ((space = static_cast<const char *>(
+				std::memchr(cypherText, ' ', end - cypherText))))
+		{
+			// Get the chunk. 
+			chunks.push_back(string(cypherText, space));
+			cypherText = space + 1;
+		}
+	for (unsigned long int i(0); i < chunks.size(); i++)
+		if (chunks[i] >= key.GetModulus())
+			throw "Error RSA02: Chunk too large.";
+	
+	RSA::powerModChunks(chunks, key, parallel);
+	
+	// Decode the message to a readable form. 
+	string message;
+	for (unsigned long int k(0); k < chunks.size(); k++)
+		if (packed)
+			message.append(RSA::decodePacked(chunks[k]));
+		else
+			message.append(RSA::decode(chunks[k]));
 	return message;
 }
 
@@ -216,125 +760,694 @@ void RSA::fileError(bool eof, bool bad)
 		throw "Error RSA05: File contains unexpected data.";
 }
 
-/* Returns the string "message" RSA-encrypted using the key "key". */
-string RSA::Encrypt(const string &message, const Key &key)
+/* Returns the string "message" RSA-encrypted using the key "key", 
+ * in the format "format". TEXT is the default so that older 
+ * versions can still decrypt it. */
+string RSA::Encrypt(const string &message, const Key &key, Format format)
 {
 	RSA::checkKeyLength(key);
 	
-	return RSA::encryptString(message, key);
+	if (format == TEXT)
+		return RSA::encryptString(message.data(), message.length(), key);
+	// The other formats are written the same way as by an Encryptor. 
+	Encryptor encryptor(key, format);
+	string cypherText(encryptor.Update(message.data(), message.length()));
+	cypherText.append(encryptor.Finish());
+	return cypherText;
 }
 
 /* Encrypts the file "sourceFile" using the key "key" and saves 
- * the result into the file "destFile". */
+ * the result into the file "destFile" in the format "format". */
 void RSA::Encrypt(	const char *sourceFile, const char *destFile, 
+					const Key &key, Format format)
+{
+	RSA::checkKeyLength(key);
+	
+	RSA::processFile(sourceFile, destFile, key, false, format);
+}
+
+/* Returns the string "cypherText" RSA-decrypted using the key 
+ * "key". The format is recognized by itself. */
+string RSA::Decrypt(const string &cypherText, const Key &key)
+{
+	RSA::checkKeyLength(key);
+	
+	char version;
+	if (!RSA::readHeader(cypherText.data(), cypherText.length(), key, version))
+		return RSA::decryptString(cypherText.data(), cypherText.length(), key);
+	Decryptor decryptor(key);
+	string message(decryptor.Update(cypherText.data(), cypherText.length()));
+	message.append(decryptor.Finish());
+	return message;
+}
+
+/* Decrypts the file "sourceFile" using the key "key" and saves 
+ * the result into the file "destFile". */
+void RSA::Decrypt(	const char *sourceFile, const char *destFile, 
 					const Key &key)
 {
 	RSA::checkKeyLength(key);
 	
-	//open the input and output files
-	std::ifstream source(sourceFile, std::ios::in | std::ios::binary);
-	if (!source)
-		throw "Error RSA06: Opening file \"sourceFile\" failed.";
-	std::ofstream dest(destFile, std::ios::out | std::ios::binary);
-	if (!dest)
-		throw "Error RSA07: Creating file \"destFile\" failed.";
+	RSA::processFile(sourceFile, destFile, key, true);
+}
+
+/* Creates an encryptor for messages encrypted using "key" in the 
+ * format "format". */
+RSA::Encryptor::Encryptor(const Key &key, Format format) : 
+	key(key), format(format), 
+	chunkWidth(format != TEXT ? RSA::byteLength(key.GetModulus()) : 0), 
+	bufferSize(4096), encrypted(0), started(false), finished(false)
+{
+	RSA::checkKeyLength(key);
+	
+	if (format == HYBRID)
+	{
+		sessionKey = RSA::newSessionKey();
+		cipher = RSA::sessionCipher(sessionKey);
+	}
 	
-	//find the source file length
-	source.seekg(0, std::ios::end);
-	const unsigned long int fileSize = source.tellg();
-	source.seekg(0, std::ios::beg);
+	//full buffers make full chunks
+	const unsigned long int chunkSize(RSA::chunkSize(key, format == BINARY));
+	if (bufferSize > chunkSize)
+		bufferSize -= bufferSize % chunkSize;
+	else
+		bufferSize = chunkSize;
+	buffer.reserve(bufferSize);
+}
+
+/* Adds "length" bytes at "data" to the message and returns the 
+ * cyphertext that is ready. */
+std::string RSA::Encryptor::Update(const char *data, unsigned long int length)
+{
+	if (finished)
+		throw "Error RSA14: The stream is already finished.";
+	//the key stream of a HYBRID message must not repeat
+	if (format == HYBRID && length > ChaCha20::StreamSize - encrypted)
+		throw "Error RSA18: The message is too long for the HYBRID format.";
 	
-	//create an input buffer
-	const unsigned long int bufferSize = 4096;
-	char buffer[bufferSize];
+	string cypherText;
+	if (!started && format != TEXT)
+		cypherText = RSA::binaryHeader(chunkWidth, format == HYBRID);
+	if (!started && format == HYBRID)
+		cypherText.append(RSA::encryptString(	sessionKey.data(), 
+												sessionKey.length(), key, 
+												true, chunkWidth));
+	started = true;
 	
-	//encrypt file chunks
-	const unsigned long int chunkCount = fileSize / bufferSize;
-	for (unsigned long int i(0); i <= chunkCount; i++)
+	//HYBRID data doesn't need to be buffered
+	if (format == HYBRID)
 	{
-		unsigned long int readLength; 
-		//read the chunk
-		if (i == chunkCount)	//if it's the last one
-			readLength = fileSize % bufferSize;
-		else
-			readLength = sizeof buffer;
-		source.read(buffer, readLength);
-		if (!source)
-			RSA::fileError(source.eof(), source.bad());
-		
-		//encrypt the chunk
-		std::string chunk(buffer, readLength);
-		chunk = RSA::encryptString(chunk, key);
-		//write the chunk
-		dest.write(chunk.c_str(), chunk.length());
-		if (!dest)
-			RSA::fileError(dest.eof(), dest.bad());
+		const unsigned long int offset(cypherText.length());
+		cypherText.resize(offset + length);
+		cipher.Process(data, &cypherText[offset], length);
+		encrypted += length;
+		return cypherText;
 	}
 	
-	source.close();
-	dest.close();
+	while (length)
+	{
+		unsigned long int size(bufferSize - buffer.length());
+		if (size > length)
+			size = length;
+		buffer.append(data, size);
+		data += size;
+		length -= size;
+		if (buffer.length() == bufferSize)
+		{
+			cypherText.append(RSA::encryptString(	buffer.data(), 
+													buffer.length(), key, 
+													true, chunkWidth));
+			buffer.clear();
+		}
+	}
+	return cypherText;
 }
 
-/* Returns the string "cypherText" RSA-decrypted using the key "key". */
-string RSA::Decrypt(const string &cypherText, const Key &key)
+/* Ends the message and returns the rest of the cyphertext. */
+std::string RSA::Encryptor::Finish()
+{
+	string cypherText(Update(0, 0));
+	cypherText.append(RSA::encryptString(	buffer.data(), buffer.length(), 
+											key, true, chunkWidth));
+	buffer.clear();
+	finished = true;
+	return cypherText;
+}
+
+/* Creates a decryptor for cyphertext encrypted using the other key of 
+ * the keypair "key" belongs to. */
+RSA::Decryptor::Decryptor(const Key &key) : 
+	key(key), chunkWidth(0), version(0), headerRead(false), 
+	finished(false)
 {
 	RSA::checkKeyLength(key);
+}
+
+/* Decrypts the complete chunks in the buffer. If "last" is true, the 
+ * buffer must hold complete chunks only. */
+std::string RSA::Decryptor::decryptBuffer(bool last)
+{
+	if (!headerRead)
+	{
+		//wait until the header can be told apart from a TEXT cyphertext
+		const unsigned long int magicLength(sizeof binaryMagic - 1);
+		if (!last && buffer.length() < binaryHeaderSize && 
+			buffer.compare(0, magicLength, binaryMagic, 
+				buffer.length() < magicLength ? 
+				buffer.length() : magicLength) == 0)
+			return string();
+		if (buffer.empty())
+			return string();
+		chunkWidth = RSA::readHeader(	buffer.data(), buffer.length(), 
+										key, version);
+		unsigned long int headerSize(chunkWidth ? binaryHeaderSize : 0);
+		if (version == hybridVersion)
+		{
+			//wait for the whole session key
+			headerSize += RSA::sessionKeyWidth(chunkWidth);
+			if (buffer.length() < headerSize && last)
+				RSA::fileError(true, false);
+			else if (buffer.length() < headerSize)
+				return string();
+			cipher = RSA::sessionCipher(RSA::readSessionKey(
+					buffer.data() + binaryHeaderSize, chunkWidth, key));
+		}
+		buffer.erase(0, headerSize);
+		headerRead = true;
+	}
 	
-	return RSA::decryptString(cypherText, key);
+	if (version == hybridVersion)
+	{
+		string message(buffer.length(), '\0');
+		cipher.Process(buffer.data(), &message[0], buffer.length());
+		buffer.clear();
+		return message;
+	}
+	
+	unsigned long int length(buffer.length());
+	if (chunkWidth)
+		length -= length % chunkWidth;
+	else
+		length = buffer.find_last_of(' ') + 1;
+	//a well-formed cyphertext ends with a complete chunk
+	if (last && length != buffer.length())
+		RSA::fileError(false, false);
+	
+	string message(RSA::decryptString(	buffer.data(), length, key, true, 
+										chunkWidth, 
+										version == binaryVersion));
+	buffer.erase(0, length);
+	//an unfinished TEXT chunk can't be longer than the modulus, so the 
+	//buffer stays small even if the ' ' never comes
+	if (!chunkWidth && buffer.length() > key.GetModulus().Length())
+		throw "Error RSA02: Chunk too large.";
+	return message;
 }
 
-/* Decrypts the file "sourceFile" using the key "key" and saves 
- * the result into the file "destFile". */
-void RSA::Decrypt(	const char *sourceFile, const char *destFile, 
-					const Key &key)
+/* Adds "length" bytes at "data" to the cyphertext and returns the 
+ * message that is ready. */
+std::string RSA::Decryptor::Update(const char *data, unsigned long int length)
+{
+	if (finished)
+		throw "Error RSA14: The stream is already finished.";
+	
+	//the input is taken a few kilobytes at a time, so that the buffer 
+	//never holds more than that and an unfinished chunk
+	const unsigned long int bufferSize(8192);
+	string message;
+	while (length)
+	{
+		const unsigned long int size(length < bufferSize ? 
+				length : bufferSize);
+		buffer.append(data, size);
+		data += size;
+		length -= size;
+		message.append(decryptBuffer(false));
+	}
+	return message;
+}
+
+/* Ends the cyphertext and returns the rest of the message. Throws an 
+ * exception if it is incomplete. */
+std::string RSA::Decryptor::Finish()
+{
+	if (finished)
+		throw "Error RSA14: The stream is already finished.";
+	
+	finished = true;
+	return decryptBuffer(true);
+}
+
+/* Returns the number signed in place of the SHA-256 digest "digest", 
+ * using a key with the modulus of "key". */
+BigInt RSA::encodeDigest(const string &digest, const Key &key)
+{
+	if (digest.length() != SHA256::DigestSize)
+		throw "Error RSA15: A digest must be 32 bytes long.";
+	
+	// The digest is padded like in PKCS #1 v1.5 (RFC 8017, section 9.2): 
+	// 0x00 0x01 0xFF ... 0xFF 0x00 digestInfo digest, as long as the 
+	// modulus. The leading zero isn't stored. 
+	// The padding needs at least 8 bytes of 0xFF, so the modulus has to 
+	// be at least 62 bytes (about 150 digits) long. 
+	const unsigned long int width(RSA::byteLength(key.GetModulus()) - 1);
+	const unsigned long int infoLength(sizeof digestInfo + digest.length());
+	if (width < infoLength + 10)
+		throw "Error RSA17: The key is too short for signing.";
+	
+	std::vector<unsigned char> bytes(width, 0xFF);
+	bytes[0] = 0x01;
+	bytes[width - infoLength - 1] = 0x00;
+	std::copy(digestInfo, digestInfo + sizeof digestInfo, 
+			bytes.end() - infoLength);
+	std::copy(digest.begin(), digest.end(), bytes.end() - digest.length());
+	return BigInt::FromBytes(&bytes[0], width);
+}
+
+/* Returns the SHA-256 digest of the file "sourceFile". */
+string RSA::digestFile(const char *sourceFile)
+{
+	SourceFile source(sourceFile);
+	if (!source.IsOpen())
+		throw "Error RSA16: Opening file \"sourceFile\" failed.";
+	
+	if (source.GetData())
+		return SHA256::Hash(source.GetData(), source.GetSize());
+	SHA256 sha256;
+	std::vector<char> buffer(65536);
+	for (unsigned long int length; 
+			(length = source.Read(&buffer[0], buffer.size())); )
+		sha256.Update(&buffer[0], length);
+	return sha256.Finish();
+}
+
+/* Returns the signature of the SHA-256 digest "digest" using the 
+ * private key "key". */
+BigInt RSA::SignDigest(const string &digest, const Key &key)
 {
 	RSA::checkKeyLength(key);
-		
+	
+	std::vector<BigInt> signature(1, RSA::encodeDigest(digest, key));
+	RSA::powerModChunks(signature, key, false);
+	return signature[0];
+}
+
+/* Returns the signature of the string "message" using the private 
+ * key "key". */
+BigInt RSA::Sign(const string &message, const Key &key)
+{
+	return RSA::SignDigest(	SHA256::Hash(message.data(), message.length()), 
+							key);
+}
+
+/* Returns the signature of the file "sourceFile" using the private 
+ * key "key". */
+BigInt RSA::SignFile(const char *sourceFile, const Key &key)
+{
+	return RSA::SignDigest(RSA::digestFile(sourceFile), key);
+}
+
+/* Returns true if "signature" is a signature of the SHA-256 digest 
+ * "digest" made using the private key belonging to the public key 
+ * "key". */
+bool RSA::VerifyDigest(	const string &digest, const BigInt &signature, 
+						const Key &key)
+{
+	RSA::checkKeyLength(key);
+	
+	if (!signature.IsPositive() || signature >= key.GetModulus())
+		return false;
+	std::vector<BigInt> value(1, signature);
+	RSA::powerModChunks(value, key, false);
+	return value[0] == RSA::encodeDigest(digest, key);
+}
+
+/* Returns, for every pair of a SHA-256 digest and a signature in 
+ * "signatures", true if the signature is a signature of the digest made 
+ * using the private key belonging to the public key "key". */
+std::vector<bool> RSA::VerifyBatch(
+		const std::vector<std::pair<string, BigInt> > &signatures, 
+		const Key &key)
+{
+	RSA::checkKeyLength(key);
+	
+	// Malformed pairs fail without stopping the others, the rest are 
+	// exponentiated together and in parallel. 
+	std::vector<bool> results(signatures.size(), false);
+	std::vector<unsigned long int> indices;
+	std::vector<BigInt> values, expected;
+	for (unsigned long int i(0); i < signatures.size(); i++)
+	{
+		const BigInt &signature(signatures[i].second);
+		if (signatures[i].first.length() != SHA256::DigestSize || 
+			!signature.IsPositive() || signature >= key.GetModulus())
+			continue;
+		indices.push_back(i);
+		values.push_back(signature);
+		expected.push_back(RSA::encodeDigest(signatures[i].first, key));
+	}
+	
+	RSA::powerModChunks(values, key);
+	for (unsigned long int i(0); i < values.size(); i++)
+		results[indices[i]] = values[i] == expected[i];
+	return results;
+}
+
+/* Returns true if "signature" is a signature of the string "message" 
+ * made using the private key belonging to the public key "key". */
+bool RSA::Verify(	const string &message, const BigInt &signature, 
+					const Key &key)
+{
+	return RSA::VerifyDigest(	SHA256::Hash(message.data(), message.length()), 
+								signature, key);
+}
+
+/* Returns true if "signature" is a signature of the file "sourceFile" 
+ * made using the private key belonging to the public key "key". */
+bool RSA::VerifyFile(	const char *sourceFile, const BigInt &signature, 
+						const Key &key)
+{
+	return RSA::VerifyDigest(RSA::digestFile(sourceFile), signature, key);
+}
+
+/* Encrypts or decrypts the file "sourceFile" using "key" and writes the 
+ * result to the file "destFile". The calling thread reads the blocks, a set 
+ * of worker threads encrypts or decrypts them, and another thread writes 
+ * them in order. There are never more than pipelineDepth blocks in memory: 
+ * the reader waits for the writer to give a block back before reading a 
+ * new one. A mapped source file isn't copied at all, the blocks point 
+ * straight into it. */
+void RSA::processFile(	const char *sourceFile, const char *destFile, 
+						const Key &key, bool decrypt, Format format)
+{
 	//open the input and output files
-	std::ifstream source(sourceFile, std::ios::in | std::ios::binary);
-	if (!source)
+	SourceFile source(sourceFile);
+	if (!source.IsOpen() && decrypt)
 		throw "Error RSA08: Opening file \"sourceFile\" failed.";
-	std::ofstream dest(destFile, std::ios::out | std::ios::binary);
-	if (!dest)
+	else if (!source.IsOpen())
+		throw "Error RSA06: Opening file \"sourceFile\" failed.";
+	DestFile dest(destFile);
+	if (!dest.IsOpen() && decrypt)
 		throw "Error RSA09: Creating file \"destFile\" failed.";
+	else if (!dest.IsOpen())
+		throw "Error RSA07: Creating file \"destFile\" failed.";
+	
+	//the size of the blocks read from the source file
+	unsigned long int bufferSize(decrypt ? 8192 : 4096);
+	//the size of binary chunks, or zero for text chunks, whether binary 
+	//chunks are packed, and the session key of a HYBRID file; when 
+	//decrypting they are set by the reader, before the first block is 
+	//passed on
+	unsigned long int chunkWidth(0);
+	bool packed(false);
+	string sessionKey;
+	if (!decrypt && format == HYBRID)
+	{
+		chunkWidth = RSA::byteLength(key.GetModulus());
+		sessionKey = RSA::newSessionKey();
+		dest.Write(RSA::binaryHeader(chunkWidth, true));
+		dest.Write(RSA::encryptString(	sessionKey.data(), sessionKey.length(), 
+										key, true, chunkWidth));
+		//the stream cipher is fast, so the blocks can be bigger
+		bufferSize = 65536;
+	}
+	else if (!decrypt && format == BINARY)
+	{
+		chunkWidth = RSA::byteLength(key.GetModulus());
+		packed = true;
+		dest.Write(RSA::binaryHeader(chunkWidth, false));
+		//full blocks make full chunks
+		const unsigned long int chunkSize(RSA::chunkSize(key, true));
+		if (bufferSize > chunkSize)
+			bufferSize -= bufferSize % chunkSize;
+		else
+			bufferSize = chunkSize;
+	}
+	unsigned long int depth(RSA::pipelineDepth);
+	if (depth < 2)
+		depth = 2;
+	
+	std::vector<Block> blocks(depth);
+	BlockQueue freeBlocks, readBlocks;
+	for (unsigned long int i(0); i < depth; i++)
+		freeBlocks.Push(&blocks[i]);
+	
+	//processed blocks wait here for their turn to be written, block 
+	//number i in slot number i % depth
+	std::vector<Block *> processedBlocks(depth, (Block *) 0);
+	std::mutex processedMutex;
+	std::condition_variable blockProcessed;
+	//the number of blocks read, known when the reader is finished
+	unsigned long int blockCount(0);
+	bool readerFinished(false);
+	
+	//the first error stops the pipeline and is rethrown at the end
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	std::atomic<bool> failed(false);
+	auto fail = [&]()
+	{
+		std::lock_guard<std::mutex> lock(errorMutex);
+		if (!error)
+			error = std::current_exception();
+		failed = true;
+	};
+	
+	//the workers encrypt or decrypt blocks in any order
+	auto work = [&]()
+	{
+		for (Block *block; (block = readBlocks.Pop()); )
+		{
+			try
+			{
+				//the pipeline keeps the threads busy, so the chunks of 
+				//a block are processed serially
+				if (!failed && !sessionKey.empty())
+				{
+					//HYBRID blocks are encrypted and decrypted the same 
+					//way, from their own position in the key stream
+					ChaCha20 cipher(RSA::sessionCipher(sessionKey));
+					cipher.Seek(block->offset);
+					block->output.resize(block->length);
+					cipher.Process(	block->data, &block->output[0], 
+									block->length);
+				}
+				else if (!failed && decrypt)
+					block->output = RSA::decryptString(	block->data, 
+														block->length, 
+														key, false, 
+														chunkWidth, 
+														packed);
+				else if (!failed)
+					block->output = RSA::encryptString(	block->data, 
+														block->length, 
+														key, false, 
+														chunkWidth);
+			}
+			catch (...)
+			{
+				fail();
+			}
+			std::lock_guard<std::mutex> lock(processedMutex);
+			processedBlocks[block->index % depth] = block;
+			blockProcessed.notify_all();
+		}
+	};
 	
-	//find the source file length
-	source.seekg(0, std::ios::end);
-	const unsigned long int fileSize = source.tellg();
-	source.seekg(0, std::ios::beg);
+	//the writer writes blocks in the order they were read, together with 
+	//the blocks following them that are already processed
+	auto write = [&]()
+	{
+		std::vector<Block *> ready;
+		for (unsigned long int next(0); ; )
+		{
+			{
+				std::unique_lock<std::mutex> lock(processedMutex);
+				while (!processedBlocks[next % depth] && 
+						!(readerFinished && next == blockCount))
+					blockProcessed.wait(lock);
+				for (Block *block; 
+						(block = processedBlocks[next % depth]) && 
+						block->index == next; next++)
+				{
+					ready.push_back(block);
+					processedBlocks[next % depth] = 0;
+				}
+			}
+			if (ready.empty())
+				return;
+			try
+			{
+				if (!failed)
+					dest.Write(ready);
+			}
+			catch (...)
+			{
+				fail();
+			}
+			for (unsigned long int i(0); i < ready.size(); i++)
+				freeBlocks.Push(ready[i]);
+			ready.clear();
+		}
+	};
 	
-	//create an input buffer
-	const unsigned long int bufferSize = 8192;
-	char buffer[bufferSize];
-	unsigned long int readCount = 0;
+	const unsigned long int workerCount(
+			ThreadPool::GetDefault().GetThreadCount());
+	std::vector<std::thread> threads;
+	for (unsigned long int i(0); i < workerCount; i++)
+		threads.push_back(std::thread(work));
+	threads.push_back(std::thread(write));
 	
-	while (readCount < fileSize)
+	//the reader
+	try
 	{
-		unsigned long int readLength; 
-		//read new data
-		if (fileSize - readCount >= bufferSize)	//if it's not the last one
-			readLength = sizeof buffer;
+		//the unfinished chunk at the end of a block is carried over to the 
+		//next block, unless the source file is mapped
+		std::string carry;
+		std::vector<char> buffer(bufferSize);
+		const char *data(source.GetData());
+		const char *end(data + source.GetSize());
+		unsigned long int readLength;
+		
+		if (decrypt)
+		{
+			//read enough to recognize the format
+			if (!data)
+				while (carry.length() < binaryHeaderSize && 
+						(readLength = source.Read(&buffer[0], bufferSize)))
+					carry.append(&buffer[0], readLength);
+			char version;
+			if (data)
+				chunkWidth = RSA::readHeader(data, end - data, key, version);
+			else
+				chunkWidth = RSA::readHeader(	carry.data(), carry.length(), 
+												key, version);
+			packed = version == binaryVersion;
+			
+			//the header of a HYBRID file is followed by the session key
+			unsigned long int headerSize(chunkWidth ? binaryHeaderSize : 0);
+			if (version == hybridVersion)
+			{
+				headerSize += RSA::sessionKeyWidth(chunkWidth);
+				//the stream cipher is fast, so the blocks can be bigger
+				bufferSize = 65536;
+				buffer.resize(bufferSize);
+			}
+			if (!data)
+				while (carry.length() < headerSize && 
+						(readLength = source.Read(&buffer[0], bufferSize)))
+					carry.append(&buffer[0], readLength);
+			if (data ? static_cast<unsigned long int>(end - data) < headerSize : 
+					carry.length() < headerSize)
+				RSA::fileError(true, false);
+			if (version == hybridVersion)
+				sessionKey = RSA::readSessionKey(
+						(data ? data : carry.data()) + binaryHeaderSize, 
+						chunkWidth, key);
+			if (data)
+				data += headerSize;
+			else
+				carry.erase(0, headerSize);
+		}
+		const bool hybrid(!sessionKey.empty());
+		unsigned long long int offset(0);
+		
+		if (data)
+			while (!failed && data < end)
+			{
+				unsigned long int length(bufferSize);
+				if (decrypt && chunkWidth && !hybrid)
+					length = bufferSize > chunkWidth ? 
+							bufferSize - bufferSize % chunkWidth : chunkWidth;
+				if (length > static_cast<unsigned long int>(end - data))
+					length = end - data;
+				//ciphertext chunks must not be split between blocks, so 
+				//the block ends after the last ' ' in it, or after the 
+				//first one following it if a chunk is longer than a block
+				if (decrypt && !chunkWidth && !hybrid)
+				{
+					const char *space(data + length);
+					while (space > data && *(space - 1) != ' ')
+						space--;
+					if (space == data)
+					{
+						space = static_cast<const char *>(std::memchr(
+								data + length, ' ', end - data - length));
+						//a well-formed cyphertext ends with a ' '
+						if (!space)
+							RSA::fileError(false, false);
+						space++;
+					}
+					length = space - data;
+				}
+				
+				if (hybrid && length > ChaCha20::StreamSize - offset)
+					throw "Error RSA18: The message is too long for the "
+							"HYBRID format.";
+				Block *block(freeBlocks.Pop());
+				block->index = blockCount++;
+				block->offset = offset;
+				block->data = data;
+				block->length = length;
+				readBlocks.Push(block);
+				data += length;
+				offset += length;
+			}
 		else
-			readLength = fileSize - readCount;
-		source.read(buffer, readLength);
-		if (!source)
-			RSA::fileError(source.eof(), source.bad());
+			while (!failed)
+			{
+				unsigned long int length(carry.length());
+				if (decrypt && chunkWidth && !hybrid)
+					length -= length % chunkWidth;
+				else if (decrypt && !hybrid)
+					length = carry.find_last_of(' ') + 1;
+				if (hybrid && length > ChaCha20::StreamSize - offset)
+					throw "Error RSA18: The message is too long for the "
+							"HYBRID format.";
+				if (length)
+				{
+					Block *block(freeBlocks.Pop());
+					block->index = blockCount++;
+					block->offset = offset;
+					block->input.assign(carry, 0, length);
+					block->data = block->input.data();
+					block->length = length;
+					carry.erase(0, length);
+					readBlocks.Push(block);
+					offset += length;
+				}
+				//an unfinished TEXT chunk can't be longer than the 
+				//modulus, so "carry" stays small even if the ' ' never 
+				//comes
+				if (decrypt && !chunkWidth && !hybrid && 
+					carry.length() > key.GetModulus().Length())
+					throw "Error RSA02: Chunk too large.";
+				
+				if (!(readLength = source.Read(&buffer[0], bufferSize)))
+					break;
+				carry.append(&buffer[0], readLength);
+			}
 		
-		//find the next chunk
-		std::string chunk(buffer, readLength);
-		chunk = chunk.substr(0, chunk.find_last_of(' ', chunk.length()) + 1);
-		readCount += chunk.length();
-		source.seekg(readCount, std::ios::beg);
-		//decrypt the chunk
-		chunk = RSA::decryptString(chunk, key);
-		//write the chunk
-		dest.write(chunk.c_str(), chunk.length());
-		if (!dest)
-			RSA::fileError(dest.eof(), dest.bad());
+		//a well-formed cyphertext ends with a complete chunk
+		if (!failed && !carry.empty())
+			RSA::fileError(false, false);
+	}
+	catch (...)
+	{
+		fail();
 	}
 	
-	source.close();
-	dest.close();
+	readBlocks.Close();
+	{
+		std::lock_guard<std::mutex> lock(processedMutex);
+		readerFinished = true;
+		blockProcessed.notify_all();
+	}
+	for (unsigned long int i(0); i < threads.size(); i++)
+		threads[i].join();
+	
+	if (error)
+		std::rethrow_exception(error);
 }
 
 /* Generates a public/private keypair. The keys are retured in a 
@@ -360,15 +1473,15 @@ KeyPair RSA::GenerateKeyPair(	unsigned long int digitCount,
 	BigInt n(p * q);
 	
 	//calculate the totient phi
-	BigInt phi((p - BigIntOne) * (q - BigIntOne));
+	BigInt phi((p - 1UL) * (q - 1UL));
 	
 	//select a small odd integer e that is coprime with phi and e < phi
 	//usually 65537 is used, and we will use it too if it fits
 	//it is recommended that this be the least possible value for e
-	BigInt e("65537");
+	BigInt e(65537UL);
 	
 	//make sure the requirements are met
-	while (RSA::GCD(phi, e) != BigIntOne || e < "65537" || !e.IsOdd())
+	while (RSA::GCD(phi, e) != BigIntOne || e < 65537UL || !e.IsOdd())
 	{
 		PrimeGenerator::MakeRandom(e, 5);
 	}
@@ -384,9 +1497,13 @@ KeyPair RSA::GenerateKeyPair(	unsigned long int digitCount,
 	if (!d.IsPositive())
 		return RSA::GenerateKeyPair(digitCount, k);
 	
+	//calculate the values used to decrypt and sign faster, using the 
+	//Chinese Remainder Theorem
+	const BigInt qInv(Residue(q, p).Inverse().GetValue());
+	
 	//we can create the private key
 	//d is the private key exponent, n is the modulus
-	Key privateKey(n, d);
+	Key privateKey(n, d, p, q, d % (p - 1UL), d % (q - 1UL), qInv);
 	
 	//finally, the keypair is created and returned
 	KeyPair newKeyPair(privateKey, publicKey);
@@ -29,17 +29,55 @@
  * 	- Message encryption (string and file) (Encrypt())
  * 	- Message decryption (string and file) (Decrypt())
  * 	- Public/private keypair generation (GenerateKeyPair())
+ * 	- Digital signatures of SHA-256 digests (string and file) (Sign(), 
+ * 		Verify())
+ * 	- Verification of many signatures at once (VerifyBatch())
+ * 
+ * Messages longer than a few chunks are encrypted and decrypted in parallel, 
+ * using the threads of ThreadPool::GetDefault(). The number of chunks 
+ * needed to go parallel can be changed (SetParallelThreshold()). 
+ * Files are read, encrypted or decrypted, and written at the same time, 
+ * using a limited amount of memory (SetPipelineDepth()). 
+ * 
+ * Encrypted files and strings are written in one of three formats 
+ * (Format): 
+ * 
+ * 	- TEXT: the encrypted chunks as decimal numbers, each followed by a ' '
+ * 	- BINARY: a header followed by the encrypted chunks as binary numbers
+ * 		The header is the 4 characters "RSAB", a version byte and the size 
+ * 		of a chunk in bytes (4 bytes, big-endian). Every chunk is stored 
+ * 		big-endian, padded with zeroes to the size of the key modulus. 
+ * 		The message bytes are packed into the chunks as base 256 digits 
+ * 		(version 2), so a chunk carries almost as many bytes as the 
+ * 		modulus has. Version 1 files use the TEXT encoding, three decimal 
+ * 		digits per byte. 
+ * 	- HYBRID: the BINARY header (version 3), followed by a random session 
+ * 		key encrypted like a BINARY file, followed by the message encrypted 
+ * 		using the ChaCha20 stream cipher and the session key 
+ * 		Only the session key is RSA-encrypted, so big files are encrypted 
+ * 		and decrypted much faster. The message can be at most 
+ * 		ChaCha20::StreamSize (256 GiB) long. 
+ * 
+ * Decrypt() recognizes the format of a file or a string by itself. 
+ * 
+ * Signatures are made like in PKCS #1 v1.5 (RFC 8017), using SHA256, and 
+ * need keys at least 62 bytes (about 150 digits) long. Keys generated by 
+ * GenerateKeyPair() hold the factors of the modulus, so decryption and 
+ * signing use the Chinese Remainder Theorem (see Key). 
+ * Keys with the exponent 65537 are applied using 17 multiplications. 
+ * 
+ * Data that arrives a piece at a time (from a socket or a pipe) can be 
+ * encrypted using an Encryptor and decrypted using a Decryptor. They are 
+ * fed using Update() and return as much output as can be produced so far; 
+ * Finish() returns the rest. Their output is the same as that of the file 
+ * methods, and they only buffer a few kilobytes of input. 
  * 
  * NOTE: All methods are static. Instantiation, copying and assignment of 
  * 	objects of type RSA is forbidden. 
  * 
- * NOTE: it is highly recommended to call 
- * 		std::srand(time(NULL));
- * 	once when the program starts and before any use of methods provided by the 
- * 	RSA class. Calling the srand() function randomizes the standard C++ 
- * 	pseudorandom number generator, so that it provides different series of 
- * 	pseudorandom numbers every time the program is run. This greatly improves 
- * 	security. 
+ * NOTE: Keys are generated using random numbers seeded from 
+ * 	std::random_device (see PrimeGenerator), so std::srand() doesn't need 
+ * 	to be called. 
  * 
  * ****************************************************************************
  */
@@ -49,12 +87,24 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <atomic>
+#include <utility>
 #include "KeyPair.h"
 #include "Key.h"
 #include "BigInt.h"
+#include "ChaCha20.h"
 
 class RSA
 {
+	public:
+		/* Formats of encrypted files. */
+		enum Format 
+		{
+			TEXT, 
+			BINARY, 
+			HYBRID
+		};
 	private:
 		/* Instantiation of objects of type RSA is forbidden. */
 		RSA()
@@ -63,6 +113,12 @@ class RSA
 		RSA(const RSA &rsa);
 		/* Assignment of objects of type RSA is forbidden. */
 		RSA &operator=(const RSA &rsa);
+		/* The smallest number of chunks that is processed in parallel. 
+		 * Zero means never. */
+		static std::atomic<unsigned long int> parallelThreshold;
+		/* The number of file blocks in memory during file encryption 
+		 * and decryption. */
+		static std::atomic<unsigned long int> pipelineDepth;
 		/* Returns the greatest common divisor of the two arguments 
 		 * "a" and "b", using the Euclidean algorithm. */
 		static BigInt GCD(const BigInt &a, const BigInt &b);
@@ -87,38 +143,218 @@ class RSA
 		static BigInt encode(const std::string &message);
 		/* Transforms a BigInt cyphertext into a std::string cyphertext. */
 		static std::string decode(const BigInt &message);
-		/* Encrypts a "chunk" (a small part of a message) using "key" */
-		static std::string encryptChunk(const std::string &chunk, 
-										const Key &key);
-		/* Decrypts a "chunk" (a small part of a message) using "key" */
-		static std::string decryptChunk(const BigInt &chunk, 
-										const Key &key);
-		/* Encrypts a string "message" using "key". */
-		static std::string encryptString(	const std::string &message, 
-											const Key &key);
-		/* Decrypts a string "message" using "key". */
-		static std::string decryptString(	const std::string &cypherText, 
+		/* Transforms "length" bytes of a message at "message" into a 
+		 * BigInt message, packing the bytes as base 256 digits. */
+		static BigInt encodePacked(	const char *message, 
+									unsigned long int length);
+		/* Transforms a BigInt message encoded using encodePacked() back 
+		 * into a std::string message. */
+		static std::string decodePacked(const BigInt &message);
+		/* Returns the number of message bytes that fit into one chunk 
+		 * encrypted using "key", when the chunk is encoded using 
+		 * encodePacked() if "packed" is true, or encode() otherwise. */
+		static unsigned long int chunkSize(const Key &key, bool packed);
+		/* Returns the number of bytes needed to store "number". */
+		static unsigned long int byteLength(const BigInt &number);
+		/* Returns the header of a BINARY file, or a HYBRID file if 
+		 * "hybrid" is true, with chunks "chunkWidth" bytes long. */
+		static std::string binaryHeader(unsigned long int chunkWidth, 
+										bool hybrid);
+		/* Returns the chunk width stored in the header at the beginning of 
+		 * a BINARY or HYBRID file, "length" bytes of which are at "data", 
+		 * and the version of the file format in "version". Returns 0 for 
+		 * a TEXT file. Throws an exception if the file can't be decrypted 
+		 * using "key". */
+		static unsigned long int readHeader(const char *data, 
+											unsigned long int length, 
+											const Key &key, 
+											char &version);
+		/* Returns a new random session key. */
+		static std::string newSessionKey();
+		/* Returns the size of a session key encrypted into chunks 
+		 * "chunkWidth" bytes long. */
+		static unsigned long int sessionKeyWidth(unsigned long int chunkWidth);
+		/* Returns a ChaCha20 cipher using "sessionKey". */
+		static ChaCha20 sessionCipher(const std::string &sessionKey);
+		/* Returns the session key encrypted at "data" using "key" into 
+		 * chunks "chunkWidth" bytes long. */
+		static std::string readSessionKey(	const char *data, 
+											unsigned long int chunkWidth, 
 											const Key &key);
+		/* Raises every chunk of "chunks" to the power of the exponent of 
+		 * "key", modulo the modulus of "key", in the calling thread. */
+		static void exponentiate(std::vector<BigInt> &chunks, const Key &key);
+		/* Raises every "chunk" (an encoded part of a message) to the power 
+		 * of the exponent of "key", modulo the modulus of "key". This is 
+		 * both RSA encryption and RSA decryption. */
+		static void powerModChunks(	std::vector<BigInt> &chunks, 
+									const Key &key, 
+									bool parallel = true);
+		/* Encrypts a string "message", "length" characters long, 
+		 * using "key". The encrypted chunks are written as decimal 
+		 * numbers followed by ' ', or as binary numbers "chunkWidth" 
+		 * bytes long if "chunkWidth" is not zero. Binary chunks are 
+		 * encoded using encodePacked(). */
+		static std::string encryptString(	const char *message, 
+											unsigned long int length, 
+											const Key &key, 
+											bool parallel = true, 
+											unsigned long int chunkWidth = 0);
+		/* Decrypts a string "cypherText", "length" characters long, 
+		 * using "key". The chunks are read as decimal numbers followed 
+		 * by ' ', or as binary numbers "chunkWidth" bytes long if 
+		 * "chunkWidth" is not zero. They are decoded using decodePacked() 
+		 * if "packed" is true, or decode() otherwise. */
+		static std::string decryptString(	const char *cypherText, 
+											unsigned long int length, 
+											const Key &key, 
+											bool parallel = true, 
+											unsigned long int chunkWidth = 0, 
+											bool packed = false);
+		/* Returns the number signed in place of the SHA-256 digest 
+		 * "digest", using a key with the modulus of "key". */
+		static BigInt encodeDigest(const std::string &digest, const Key &key);
+		/* Returns the SHA-256 digest of the file "sourceFile". */
+		static std::string digestFile(const char *sourceFile);
 		/* Tests the file for 'eof', 'bad ' errors and throws an exception. */
 		static void fileError(bool eof, bool bad);
+		/* Encrypts or decrypts the file "sourceFile" using "key" and 
+		 * writes the result to the file "destFile". The file is read, 
+		 * processed and written at the same time, see SetPipelineDepth(). 
+		 * "format" is only used for encryption. */
+		static void processFile(const char *sourceFile, 
+								const char *destFile, 
+								const Key &key, 
+								bool decrypt, 
+								Format format = BINARY);
 	public:
-		/* Returns the string "message" RSA-encrypted using the key "key". */
+		/* Encrypts a stream of data, a piece at a time. */
+		class Encryptor
+		{
+			private:
+				const Key key;
+				const Format format;
+				/* The size of binary chunks, zero for TEXT. */
+				const unsigned long int chunkWidth;
+				/* The number of bytes encrypted at once. */
+				unsigned long int bufferSize;
+				/* Bytes waiting for a full buffer. */
+				std::string buffer;
+				/* The session key and cipher of a HYBRID stream. */
+				std::string sessionKey;
+				ChaCha20 cipher;
+				/* The number of bytes of a HYBRID stream encrypted. */
+				unsigned long long int encrypted;
+				bool started;
+				bool finished;
+			public:
+				/* Creates an encryptor for messages encrypted using 
+				 * "key" in the format "format". */
+				Encryptor(const Key &key, Format format = BINARY);
+				/* Adds "length" bytes at "data" to the message and 
+				 * returns the cyphertext that is ready. */
+				std::string Update(	const char *data, 
+									unsigned long int length);
+				/* Ends the message and returns the rest of the 
+				 * cyphertext. */
+				std::string Finish();
+		};
+		/* Decrypts a stream of data, a piece at a time. The format is 
+		 * recognized by itself, like by Decrypt(). */
+		class Decryptor
+		{
+			private:
+				const Key key;
+				/* The size of binary chunks, zero for TEXT. */
+				unsigned long int chunkWidth;
+				/* The version of the BINARY or HYBRID file format. */
+				char version;
+				/* The cipher of a HYBRID stream. */
+				ChaCha20 cipher;
+				/* Set when the format of the cyphertext is known. */
+				bool headerRead;
+				/* Bytes of unfinished chunks. */
+				std::string buffer;
+				bool finished;
+				/* Decrypts the complete chunks in the buffer. If "last" 
+				 * is true, the buffer must hold complete chunks only. */
+				std::string decryptBuffer(bool last);
+			public:
+				/* Creates a decryptor for cyphertext encrypted using 
+				 * the other key of the keypair "key" belongs to. */
+				explicit Decryptor(const Key &key);
+				/* Adds "length" bytes at "data" to the cyphertext and 
+				 * returns the message that is ready. */
+				std::string Update(	const char *data, 
+									unsigned long int length);
+				/* Ends the cyphertext and returns the rest of the 
+				 * message. Throws an exception if it is incomplete. */
+				std::string Finish();
+		};
+		/* Messages of at least "chunkCount" chunks will be encrypted and 
+		 * decrypted in parallel. Zero turns parallel processing off. */
+		static void SetParallelThreshold(unsigned long int chunkCount);
+		/* Files are encrypted and decrypted using at most "blockCount" 
+		 * blocks of memory, a few kilobytes each. One thread reads the 
+		 * blocks, the threads of ThreadPool::GetDefault() encrypt or 
+		 * decrypt them and one thread writes them, in order. */
+		static void SetPipelineDepth(unsigned long int blockCount);
+		/* Returns the string "message" RSA-encrypted using the key "key", 
+		 * in the format "format". TEXT is the default so that older 
+		 * versions can still decrypt it. */
 		static std::string Encrypt(	const std::string &message, 
-									const Key &key);
+									const Key &key, 
+									Format format = TEXT);
 		/* Encrypts the file "sourceFile" using the key "key" and saves 
-		 * the result into the file "destFile". */
+		 * the result into the file "destFile" in the format "format". */
 		static void Encrypt(const char *sourceFile, 
 							const char *destFile, 
-							const Key &key);
+							const Key &key, 
+							Format format = BINARY);
 		/* Decrypts the file "sourceFile" using the key "key" and saves 
 		 * the result into the file "destFile". */
 		static void Decrypt(const char *sourceFile, 
 							const char *destFile, 
 							const Key &key);
-		/* Returns the string "cypherText" RSA-decrypted 
-		 * using the key "key". */
+		/* Returns the string "cypherText" RSA-decrypted using the key 
+		 * "key". The format is recognized by itself. */
 		static std::string Decrypt(	const std::string &cypherText, 
 									const Key &key);
+		/* Returns the signature of the string "message" using the 
+		 * private key "key". */
+		static BigInt Sign(const std::string &message, const Key &key);
+		/* Returns the signature of the file "sourceFile" using the 
+		 * private key "key". */
+		static BigInt SignFile(const char *sourceFile, const Key &key);
+		/* Returns the signature of the SHA-256 digest "digest" (see 
+		 * SHA256) using the private key "key". */
+		static BigInt SignDigest(const std::string &digest, const Key &key);
+		/* Returns true if "signature" is a signature of the string 
+		 * "message" made using the private key belonging to the public 
+		 * key "key". */
+		static bool Verify(	const std::string &message, 
+							const BigInt &signature, 
+							const Key &key);
+		/* Returns true if "signature" is a signature of the file 
+		 * "sourceFile" made using the private key belonging to the 
+		 * public key "key". */
+		static bool VerifyFile(	const char *sourceFile, 
+								const BigInt &signature, 
+								const Key &key);
+		/* Returns true if "signature" is a signature of the SHA-256 
+		 * digest "digest" made using the private key belonging to the 
+		 * public key "key". */
+		static bool VerifyDigest(	const std::string &digest, 
+									const BigInt &signature, 
+									const Key &key);
+		/* Returns, for every pair of a SHA-256 digest and a signature in 
+		 * "signatures", true if the signature is a signature of the 
+		 * digest made using the private key belonging to the public key 
+		 * "key". The signatures are verified in parallel, like the chunks 
+		 * of a message (see SetParallelThreshold()). */
+		static std::vector<bool> VerifyBatch(
+				const std::vector<std::pair<std::string, BigInt> > &signatures, 
+				const Key &key);
 		/* Generates a public/private keypair. The keys are retured in a 
 		 * KeyPair. The generated keys are 'digitCount' or 
 		 * 'digitCount' + 1 digits long. */
@@ -0,0 +1,127 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				Residue.cpp
+ *
+ * This file contains the implementation for the Residue class.
+ *
+ * ****************************************************************************
+ */
+
+#include "Residue.h"
+
+/* Creates the residue of "number" modulo the modulus of "context". */
+Residue::Residue(	const std::shared_ptr<const BarrettContext> &context,
+					const BigInt &number) :
+	context(context), value(number)
+{
+	if (!context)
+		throw "Error RESIDUE00: Missing modulus context.";
+
+	context->Reduce(value);
+	//the context reduces the absolute value
+	if (!number.IsPositive() && !value.EqualsZero())
+		value = context->GetModulus() - value;
+}
+
+/* Creates the residue of "number" modulo "modulus", with a new context. */
+Residue::Residue(const BigInt &number, const BigInt &modulus) :
+	Residue(std::make_shared<const BarrettContext>(modulus), number)
+{}
+
+/* Throws an exception if "residue" isn't modulo the same number as *this. */
+void Residue::checkContext(const Residue &residue) const
+{
+	if (context != residue.context &&
+		context->GetModulus() != residue.context->GetModulus())
+		throw "Error RESIDUE01: Residues modulo different numbers.";
+}
+
+Residue operator+(const Residue &a, const Residue &b)
+{
+	a.checkContext(b);
+
+	Residue sum(a);
+	sum.value += b.value;
+	if (sum.value >= a.context->GetModulus())
+		sum.value -= a.context->GetModulus();
+	return sum;
+}
+
+Residue operator-(const Residue &a, const Residue &b)
+{
+	a.checkContext(b);
+
+	Residue difference(a);
+	if (difference.value < b.value)
+		difference.value += a.context->GetModulus();
+	difference.value -= b.value;
+	return difference;
+}
+
+Residue operator*(const Residue &a, const Residue &b)
+{
+	a.checkContext(b);
+
+	Residue product(a);
+	product.value = a.context->Multiply(a.value, b.value);
+	return product;
+}
+
+bool operator==(const Residue &a, const Residue &b)
+{
+	a.checkContext(b);
+
+	return a.value == b.value;
+}
+
+bool operator!=(const Residue &a, const Residue &b)
+{
+	return !(a == b);
+}
+
+/* Returns *this to the power of "exponent". */
+Residue Residue::Power(const BigInt &exponent) const
+{
+	Residue power(*this);
+	power.value = context->PowerMod(value, exponent);
+	return power;
+}
+
+/* Returns the multiplicative inverse of *this. Throws an exception if
+ * *this and the modulus aren't coprime. */
+Residue Residue::Inverse() const
+{
+	//the Extended Euclidean Algorithm, keeping track of the coefficient
+	//of *this only: coefficient * value = remainder (mod modulus)
+	BigInt remainder(context->GetModulus()), nextRemainder(value);
+	BigInt coefficient(BigIntZero), nextCoefficient(BigIntOne);
+	while (!nextRemainder.EqualsZero())
+	{
+		const BigInt quotient(remainder / nextRemainder);
+		BigInt temp(remainder - quotient * nextRemainder);
+		remainder = nextRemainder;
+		nextRemainder = temp;
+		temp = coefficient - quotient * nextCoefficient;
+		coefficient = nextCoefficient;
+		nextCoefficient = temp;
+	}
+	if (remainder != BigIntOne)
+		throw "Error RESIDUE02: The number is not invertible.";
+
+	return Residue(context, coefficient);
+}
@@ -0,0 +1,87 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				Residue.h
+ *
+ * A number modulo n, bound to a BarrettContext for n.
+ *
+ * Algorithms like the Miller-Rabin test or the Chinese Remainder Theorem
+ * do all of their arithmetic modulo one number. A Residue keeps its value
+ * reduced (0 <= value < n) after every operation, using the shared context,
+ * so the calling code doesn't need to reduce anything by itself. The
+ * context is reference-counted and shared by all the residues made from
+ * it, so it is computed only once.
+ *
+ * Residue supports:
+ *
+ * 	- addition, subtraction and multiplication (operator+, -, *)
+ * 	- comparison (operator==, !=)
+ * 	- exponentiation (Power())
+ * 	- the multiplicative inverse (Inverse())
+ *
+ * Both operands of an operation must be modulo the same number.
+ *
+ * ****************************************************************************
+ */
+
+#ifndef RESIDUE_H_
+#define RESIDUE_H_
+
+#include "BigInt.h"
+#include "BarrettContext.h"
+#include <memory>	//shared_ptr
+
+class Residue
+{
+	private:
+		std::shared_ptr<const BarrettContext> context;
+		/* The value, always less than the modulus. */
+		BigInt value;
+		/* Throws an exception if "residue" isn't modulo the same number
+		 * as *this. */
+		void checkContext(const Residue &residue) const;
+	public:
+		/* Creates the residue of "number" modulo the modulus of
+		 * "context". */
+		Residue(const std::shared_ptr<const BarrettContext> &context,
+				const BigInt &number);
+		/* Creates the residue of "number" modulo "modulus", with a new
+		 * context. */
+		Residue(const BigInt &number, const BigInt &modulus);
+		/* Returns the value, 0 <= value < modulus. */
+		const BigInt &GetValue() const
+		{
+			return value;
+		}
+		/* Returns the context. */
+		const std::shared_ptr<const BarrettContext> &GetContext() const
+		{
+			return context;
+		}
+		friend Residue operator+(const Residue &a, const Residue &b);
+		friend Residue operator-(const Residue &a, const Residue &b);
+		friend Residue operator*(const Residue &a, const Residue &b);
+		friend bool operator==(const Residue &a, const Residue &b);
+		friend bool operator!=(const Residue &a, const Residue &b);
+		/* Returns *this to the power of "exponent". */
+		Residue Power(const BigInt &exponent) const;
+		/* Returns the multiplicative inverse of *this. Throws an
+		 * exception if *this and the modulus aren't coprime. */
+		Residue Inverse() const;
+};
+
+#endif /*RESIDUE_H_*/
@@ -0,0 +1,187 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				SHA256.cpp
+ *
+ * This file contains the implementation for the SHA256 class.
+ *
+ * ****************************************************************************
+ */
+
+#include "SHA256.h"
+#include <cstring>	//memcpy()
+
+namespace
+{
+	/* The first 32 bits of the fractional parts of the cube roots of the
+	 * first 64 primes. */
+	const uint32_t roundConstants[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+		0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+		0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+		0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+		0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+		0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+		0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+		0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+		0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	/* Rotates "word" right by "count" bits. */
+	inline uint32_t rotate(uint32_t word, int count)
+	{
+		return (word >> count) | (word << (32 - count));
+	}
+}
+
+SHA256::SHA256()
+{
+	reset();
+}
+
+/* Starts a new message. */
+void SHA256::reset()
+{
+	//the first 32 bits of the fractional parts of the square roots of the
+	//first 8 primes
+	state[0] = 0x6a09e667;
+	state[1] = 0xbb67ae85;
+	state[2] = 0x3c6ef372;
+	state[3] = 0xa54ff53a;
+	state[4] = 0x510e527f;
+	state[5] = 0x9b05688c;
+	state[6] = 0x1f83d9ab;
+	state[7] = 0x5be0cd19;
+	used = 0;
+	length = 0;
+}
+
+/* Processes a whole 64-byte block of the message at "data". */
+void SHA256::compress(const unsigned char *data)
+{
+	//the message schedule
+	uint32_t w[64];
+	for (int i(0); i < 16; i++)
+		w[i] =	uint32_t(data[4 * i]) << 24 | uint32_t(data[4 * i + 1]) << 16 |
+				uint32_t(data[4 * i + 2]) << 8 | uint32_t(data[4 * i + 3]);
+	for (int i(16); i < 64; i++)
+	{
+		const uint32_t s0(rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^
+				(w[i - 15] >> 3));
+		const uint32_t s1(rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^
+				(w[i - 2] >> 10));
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	uint32_t a(state[0]), b(state[1]), c(state[2]), d(state[3]),
+			e(state[4]), f(state[5]), g(state[6]), h(state[7]);
+	for (int i(0); i < 64; i++)
+	{
+		const uint32_t s1(rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25));
+		const uint32_t choice((e & f) ^ (~e & g));
+		const uint32_t t1(h + s1 + choice + roundConstants[i] + w[i]);
+		const uint32_t s0(rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22));
+		const uint32_t majority((a & b) ^ (a & c) ^ (b & c));
+		const uint32_t t2(s0 + majority);
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+/* Adds "length" bytes at "data" to the message. */
+void SHA256::Update(const char *data, unsigned long int length)
+{
+	const unsigned char *bytes(reinterpret_cast<const unsigned char *>(data));
+	this->length += length;
+
+	//fill the unfinished block first
+	if (used)
+	{
+		unsigned long int size(sizeof block - used);
+		if (size > length)
+			size = length;
+		std::memcpy(block + used, bytes, size);
+		used += size;
+		bytes += size;
+		length -= size;
+		if (used < sizeof block)
+			return;
+		compress(block);
+		used = 0;
+	}
+
+	//whole blocks don't need to be copied
+	for (; length >= sizeof block; length -= sizeof block)
+	{
+		compress(bytes);
+		bytes += sizeof block;
+	}
+
+	std::memcpy(block, bytes, length);
+	used = length;
+}
+
+/* Returns the digest of the message and starts a new one. */
+std::string SHA256::Finish()
+{
+	//the padding is a 1 bit, zeroes and the message length in bits, so
+	//that the message ends at the end of a block
+	const unsigned long long int bitLength(length * 8);
+	unsigned char padding[72] = {0x80};
+	unsigned long int paddingLength(
+			used < 56 ? 56 - used : sizeof block + 56 - used);
+	for (int i(0); i < 8; i++)
+		padding[paddingLength + i] =
+				static_cast<unsigned char>(bitLength >> (56 - 8 * i));
+	Update(reinterpret_cast<const char *>(padding), paddingLength + 8);
+
+	std::string digest;
+	for (int i(0); i < 8; i++)
+		for (int j(24); j >= 0; j -= 8)
+			digest.push_back(char(state[i] >> j));
+	reset();
+	return digest;
+}
+
+/* Returns the digest of "length" bytes at "data". */
+std::string SHA256::Hash(const char *data, unsigned long int length)
+{
+	SHA256 sha256;
+	sha256.Update(data, length);
+	return sha256.Finish();
+}
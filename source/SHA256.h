@@ -0,0 +1,63 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				SHA256.h
+ *
+ * An implementation of the SHA-256 hash function, as described in FIPS 180-4.
+ *
+ * SHA-256 computes a 32-byte digest of a message of any length. The message
+ * can be given all at once or a piece at a time (Update()), so a big file
+ * doesn't need to be in memory to be hashed. Finish() returns the digest and
+ * prepares the object for a new message.
+ *
+ * ****************************************************************************
+ */
+
+#ifndef SHA256_H_
+#define SHA256_H_
+
+#include <string>	//string
+#include <stdint.h>	//uint32_t
+
+class SHA256
+{
+	private:
+		/* The intermediate hash value. */
+		uint32_t state[8];
+		/* The unfinished block of the message. */
+		unsigned char block[64];
+		/* The number of bytes in "block". */
+		unsigned long int used;
+		/* The number of bytes of the message so far. */
+		unsigned long long int length;
+		/* Processes a whole 64-byte block of the message at "data". */
+		void compress(const unsigned char *data);
+		/* Starts a new message. */
+		void reset();
+	public:
+		/* The size of a digest, in bytes. */
+		static const unsigned long int DigestSize = 32;
+		SHA256();
+		/* Adds "length" bytes at "data" to the message. */
+		void Update(const char *data, unsigned long int length);
+		/* Returns the digest of the message and starts a new one. */
+		std::string Finish();
+		/* Returns the digest of "length" bytes at "data". */
+		static std::string Hash(const char *data, unsigned long int length);
+};
+
+#endif /*SHA256_H_*/
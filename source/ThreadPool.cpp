@@ -0,0 +1,120 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				ThreadPool.cpp
+ *
+ * This file contains the implementation for the ThreadPool class.
+ *
+ * ****************************************************************************
+ */
+
+#include "ThreadPool.h"
+
+/* Creates a pool with "threadCount" worker threads. */
+ThreadPool::ThreadPool(unsigned long int threadCount) : stopping(false)
+{
+	for (unsigned long int i(0); i < threadCount; i++)
+		threads.push_back(std::thread(&ThreadPool::work, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	taskQueued.notify_all();
+	for (unsigned long int i(0); i < threads.size(); i++)
+		threads[i].join();
+}
+
+/* Runs the task at the front of the queue. Must be called with
+ * "lock" locked, returns with "lock" locked. */
+void ThreadPool::runFront(std::unique_lock<std::mutex> &lock)
+{
+	Task task(tasks.front());
+	tasks.pop_front();
+	lock.unlock();
+	std::exception_ptr error;
+	try
+	{
+		task.function();
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+	lock.lock();
+	if (error && !task.batch->error)
+		task.batch->error = error;
+	task.batch->remaining--;
+	taskFinished.notify_all();
+}
+
+/* The body of the worker threads. */
+void ThreadPool::work()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		while (!stopping && tasks.empty())
+			taskQueued.wait(lock);
+		if (tasks.empty())
+			return;
+		runFront(lock);
+	}
+}
+
+/* Runs all "batch" tasks and returns when they are finished. */
+void ThreadPool::Run(const std::vector<std::function<void()> > &batch)
+{
+	Batch state;
+	state.remaining = batch.size();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	for (unsigned long int i(0); i < batch.size(); i++)
+	{
+		Task task = {batch[i], &state};
+		tasks.push_back(task);
+	}
+	taskQueued.notify_all();
+
+	//help with the queued tasks instead of just waiting
+	while (state.remaining)
+		if (!tasks.empty())
+			runFront(lock);
+		else
+			taskFinished.wait(lock);
+
+	if (state.error)
+		std::rethrow_exception(state.error);
+}
+
+/* Returns the number of threads that run tasks, including the
+ * caller of Run(). */
+unsigned long int ThreadPool::GetThreadCount() const
+{
+	return threads.size() + 1;
+}
+
+/* Returns the pool shared by the whole program. */
+ThreadPool &ThreadPool::GetDefault()
+{
+	static ThreadPool pool(std::thread::hardware_concurrency() > 1 ?
+			std::thread::hardware_concurrency() - 1 : 0);
+	return pool;
+}
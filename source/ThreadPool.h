@@ -0,0 +1,92 @@
+/* ****************************************************************************
+ *
+ * This file is part of rsa - the RSA implementation in C++.
+ *
+ * rsa is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * rsa is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with rsa.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * 				ThreadPool.h
+ *
+ * A fixed set of worker threads running batches of independent tasks.
+ *
+ * Run() queues a batch of tasks and returns when all of them are finished.
+ * While it waits, the calling thread runs queued tasks too, so Run() may be
+ * called from inside a task without deadlocking the pool. If a task throws
+ * an exception, the rest of the batch is still run and the first exception
+ * is rethrown by Run().
+ *
+ * GetDefault() returns a pool shared by the whole program, with one thread
+ * per hardware thread (counting the caller of Run()).
+ *
+ * NOTE: Copying and assignment of objects of type ThreadPool is forbidden.
+ *
+ * ****************************************************************************
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <vector>	//vector
+#include <deque>	//deque
+#include <functional>	//function
+#include <thread>	//thread
+#include <mutex>	//mutex
+#include <condition_variable>	//condition_variable
+#include <exception>	//exception_ptr
+
+class ThreadPool
+{
+	private:
+		/* The state of a batch of tasks passed to Run(). */
+		struct Batch
+		{
+			unsigned long int remaining;
+			std::exception_ptr error;
+		};
+		/* A queued task and the batch it belongs to. */
+		struct Task
+		{
+			std::function<void()> function;
+			Batch *batch;
+		};
+		std::deque<Task> tasks;
+		std::vector<std::thread> threads;
+		bool stopping;
+		std::mutex mutex;
+		/* Signaled when a task is queued or the pool stops. */
+		std::condition_variable taskQueued;
+		/* Signaled when a task is finished. */
+		std::condition_variable taskFinished;
+		/* Copying of objects of type ThreadPool is forbidden. */
+		ThreadPool(const ThreadPool &threadPool);
+		/* Assignment of objects of type ThreadPool is forbidden. */
+		ThreadPool &operator=(const ThreadPool &threadPool);
+		/* Runs the task at the front of the queue. Must be called with
+		 * "lock" locked, returns with "lock" locked. */
+		void runFront(std::unique_lock<std::mutex> &lock);
+		/* The body of the worker threads. */
+		void work();
+	public:
+		/* Creates a pool with "threadCount" worker threads. */
+		explicit ThreadPool(unsigned long int threadCount);
+		~ThreadPool();
+		/* Runs all "batch" tasks and returns when they are finished. */
+		void Run(const std::vector<std::function<void()> > &batch);
+		/* Returns the number of threads that run tasks, including the
+		 * caller of Run(). */
+		unsigned long int GetThreadCount() const;
+		/* Returns the pool shared by the whole program. */
+		static ThreadPool &GetDefault();
+};
+
+#endif /*THREADPOOL_H_*/
@@ -34,6 +34,7 @@
 #include "test.h"	//testing functions
 #include "RSA.h"	//GenerateKeyPair()
 #include "PrimeGenerator.h"	//Generate()
+#include "SHA256.h"	//SHA256
 
 using std::cout;
 using std::endl;
@@ -77,6 +78,29 @@ void printUsage()
 	"digits long and is generated in N iterations (default N = 3 is fine). "
 	"LENGTH and N must be positive decimal integers." << endl << 
 	endl << 
+	"    encrypt MODULUS EXPONENT [text|hybrid]" << endl << 
+	"Encrypt the standard input using the key with the modulus MODULUS and " 
+	"the exponent EXPONENT, and write the result to the standard output. "
+	"The result is binary, or decimal numbers if 'text' is given. If "
+	"'hybrid' is given, only a random session key is encrypted using RSA "
+	"and the input is encrypted using the session key, which is much "
+	"faster. "
+	"MODULUS and EXPONENT must be positive decimal integers." << endl << 
+	endl << 
+	"    decrypt MODULUS EXPONENT" << endl << 
+	"Decrypt the standard input using the key with the modulus MODULUS and " 
+	"the exponent EXPONENT, and write the result to the standard output." 
+	<< endl << 
+	endl << 
+	"    sign MODULUS EXPONENT" << endl << 
+	"Sign the standard input using the private key with the modulus MODULUS "
+	"and the exponent EXPONENT, and print the signature." << endl << 
+	endl << 
+	"    verify MODULUS EXPONENT SIGNATURE" << endl << 
+	"Verify that SIGNATURE is a signature of the standard input, using the "
+	"public key with the modulus MODULUS and the exponent EXPONENT. Exit "
+	"status is 0 if the signature is valid." << endl << 
+	endl << 
 	"    test" << endl << 
 	"Run preconfigured tests (development version only)." << endl << 
 	endl << 
@@ -105,10 +129,25 @@ void test()
 		FactorialBenchmark();
 		RandomBigIntTest(1);
 		RandomBigIntDivisionTest(1);
+		RadixConversionTest(20);
+		WordArithmeticTest(20);
+		ExactDivisionTest(20);
+		LongDivisionTest(20);
+		BitOperationsTest(20);
+		ShortProductTest(20);
+		LargeProductTest(3);
+		BarrettReductionTest(20);
+		TestResidue();
+		FixedBaseTest(20);
 		TestPrimeGenerator(1, 10);
 		TestKeyGeneration(1, 8);
 		TestEncryptionDecryption(1, 8);
 		TestFileEncryptionDecryption(1, 8);
+		TestParallelEncryptionDecryption(1, 12);
+		TestChaCha20();
+		TestSignature(1, 160);
+		TestStreamEncryptionDecryption(1, 8);
+		TestKeyPool(1, 8);
 	}
 	catch (const char errorMessage[])
 	{
@@ -158,6 +197,110 @@ void genprime(unsigned long int digits, unsigned long int iterations = 0)
 	}
 }
 
+/* Feeds the standard input to "processor", an RSA::Encryptor or an 
+ * RSA::Decryptor, and writes its output as soon as it is ready. */
+template <typename Processor>
+void pipeThrough(Processor &processor)
+{
+	char buffer[4096];
+	while (cin.read(buffer, sizeof buffer) || cin.gcount())
+	{
+		std::string output(processor.Update(buffer, cin.gcount()));
+		cout.write(output.data(), output.length());
+	}
+	std::string output(processor.Finish());
+	cout.write(output.data(), output.length());
+	cout.flush();
+}
+
+void stream(const Key &key, bool decrypt, RSA::Format format = RSA::BINARY)
+{
+	try
+	{
+		if (decrypt)
+		{
+			RSA::Decryptor decryptor(key);
+			pipeThrough(decryptor);
+		}
+		else
+		{
+			RSA::Encryptor encryptor(key, format);
+			pipeThrough(encryptor);
+		}
+	}
+	catch (const char errorMessage[])
+	{
+		exitError(errorMessage);
+	}
+	catch (...)
+	{
+		exitError("Unknown error.");
+	}
+}
+
+std::string digestInput()
+{
+	SHA256 sha256;
+	char buffer[4096];
+	while (cin.read(buffer, sizeof buffer) || cin.gcount())
+		sha256.Update(buffer, cin.gcount());
+	return sha256.Finish();
+}
+
+void sign(const Key &key)
+{
+	try
+	{
+		cout << RSA::SignDigest(digestInput(), key) << endl;
+	}
+	catch (const char errorMessage[])
+	{
+		exitError(errorMessage);
+	}
+	catch (...)
+	{
+		exitError("Unknown error.");
+	}
+}
+
+void verify(const Key &key, const BigInt &signature)
+{
+	try
+	{
+		if (!RSA::VerifyDigest(digestInput(), signature, key))
+		{
+			cout << "Signature invalid." << endl;
+			std::exit(EXIT_FAILURE);
+		}
+		cout << "Signature OK." << endl;
+	}
+	catch (const char errorMessage[])
+	{
+		exitError(errorMessage);
+	}
+	catch (...)
+	{
+		exitError("Unknown error.");
+	}
+}
+
+Key parseKey(int argc, char *argv[])
+{
+	if (argc < 3)
+		missingArgumentError("MODULUS");
+	if (argc < 4)
+		missingArgumentError("EXPONENT");
+	try
+	{
+		return Key(BigInt(argv[2]), BigInt(argv[3]));
+	}
+	catch (...)
+	{
+		exitError("'MODULUS' and 'EXPONENT' must be positive integers.");
+	}
+	return Key(BigInt(), BigInt());
+}
+
 void parseParams(int argc, char *argv[])
 {
 	if (strcmp(argv[1], "genkey") == 0)	//generate and print a RSA key
@@ -204,6 +347,38 @@ void parseParams(int argc, char *argv[])
 		else
 			genprime(digits);
 	}
+	else if (strcmp(argv[1], "encrypt") == 0)	//encrypt a stream
+	{
+		Key key(parseKey(argc, argv));
+		if (argc < 5)
+			stream(key, false);
+		else if (strcmp(argv[4], "text") == 0)
+			stream(key, false, RSA::TEXT);
+		else if (strcmp(argv[4], "hybrid") == 0)
+			stream(key, false, RSA::HYBRID);
+		else
+			exitError("Unrecognized format.");
+	}
+	else if (strcmp(argv[1], "decrypt") == 0)	//decrypt a stream
+		stream(parseKey(argc, argv), true);
+	else if (strcmp(argv[1], "sign") == 0)	//sign a stream
+		sign(parseKey(argc, argv));
+	else if (strcmp(argv[1], "verify") == 0)	//verify a signature
+	{
+		Key key(parseKey(argc, argv));
+		if (argc < 5)
+			missingArgumentError("SIGNATURE");
+		BigInt signature;
+		try
+		{
+			signature = argv[4];
+		}
+		catch (...)
+		{
+			exitError("'SIGNATURE' must be a positive integer.");
+		}
+		verify(key, signature);
+	}
 	else if (strcmp(argv[1], "test") == 0)	//run all the tests
 		test();
 	else
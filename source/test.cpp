@@ -33,11 +33,25 @@
 #include "Key.h"	//Key
 #include "KeyPair.h"	//KeyPair
 #include "RSA.h"	//GenerateKeyPair()
+#include "KeyPool.h"	//KeyPool
+#include "ChaCha20.h"	//ChaCha20
+#include "SHA256.h"	//SHA256
+#include "BarrettContext.h"	//BarrettContext
+#include "Residue.h"	//Residue
+#include "FixedBase.h"	//FixedBase
 #include <iostream>	//cout, cin
 #include <ctime>	//clock...
 #include <cstdlib>
 #include <string>	//BigInt::operator std::string() const
 #include <climits>	// ULONG_MAX
+#include <vector>	//PowerModBatch()
+#include <cstring>	//strlen()
+#include <cstdint>	//uint32_t
+#include <fstream>	//ofstream
+#if defined(__linux__)
+#include <sys/stat.h>	//mkfifo()
+#include <unistd.h>	//unlink()
+#endif
 
 using std::cout;
 using std::endl;
@@ -284,6 +298,37 @@ void TestBigIntFunctions()
 	a = "22";
 	test(a.GetPowerMod("6", "37"), "27");
 	
+	//test PowerModBatch()
+	std::vector<BigInt> batch;
+	batch.push_back(3);
+	batch.push_back("22");
+	batch.push_back(BigIntZero);
+	BigInt::PowerModBatch(batch, 6, 37);
+	test(batch[0], 26);
+	test(batch[1], 27);
+	test(batch[2], BigIntZero);
+	//an exponent long enough for windows of 5 bits (3^400)
+	batch.assign(1, 2);
+	batch.push_back("123456789");
+	batch.push_back("1000000000000000000000000000056");
+	BigInt::PowerModBatch(batch, 
+			"705507910865533257124642715759347962165079496127873157628712"
+			"232092620855515829341565792985294471341581549523348253559118"
+			"669297930718245666941450844545352570279602853237603131924432"
+			"83334088001", "1000000000000000000000000000057");
+	test(batch[0], "274872217968514962977234272559");
+	test(batch[1], "686854941423095049177371642873");
+	test(batch[2], "1000000000000000000000000000056");
+	//the exponent 65537 and the largest exponent that fits into an 
+	//unsigned long int take shortcuts
+	a = "123456789";
+	test(a.GetPowerMod(65537, 1000000007), "560583526");
+	a = "98765432123456789";
+	test(a.GetPowerMod(65537, "1000000000000000000000000000057"), 
+			"961143120910353635576668751733");
+	a = 2;
+	test(a.GetPowerMod("18446744073709551615", 1000000009), "120356229");
+	
 	//test ToString()
 	a = "10000000000";
 	cout << a.ToString() << endl;
@@ -522,6 +567,12 @@ void TestBigIntOperators()
 		a = "44444";
 		b = "99999";
 		test(a * b, "4444355556");
+		a = "4294967296";
+		test(a * a, "18446744073709551616");
+		a = std::string(300, '9');
+		b = "99";
+		test(a * b, "98" + std::string(298, '9') + "01");
+		test(b * a, "98" + std::string(298, '9') + "01");
 		a = "0";
 		test(a * b, "0");
 		
@@ -885,6 +936,453 @@ void RandomBigIntDivisionTest(unsigned long int testCount)
 	cout << "\nRandom division test finished!" << endl;
 }
 
+/* Returns a random number "digitCount" digits long. */
+BigInt randomBigInt(unsigned long int digitCount)
+{
+	std::string digits(1, char('1' + myRand(9)));
+	while (digits.length() < digitCount)
+		digits.push_back(char('0' + myRand(10)));
+	return BigInt(digits);
+}
+
+/*				RADIX CONVERSION TEST					*/
+void RadixConversionTest(unsigned long int testCount)
+{
+	cout << "\n\n\tRADIX CONVERSION TEST\n\n";
+	
+	bool thrown(false);
+	std::vector<std::uint32_t> words;
+	BigIntZero.ToWords(words);
+	test(words.empty(), true);
+	test(BigInt::FromWords(words), BigIntZero);
+	//2^64 + 5 and the leaves of 19 digits
+	BigInt("-18446744073709551621").ToWords(words);
+	test(words.size() == 3 && words[0] == 5 && words[1] == 0 && words[2] == 1, 
+			true);
+	const char *edges[] = {"9999999999999999999", "10000000000000000000", 
+			"18446744073709551615", "18446744073709551616", 
+			"340282366920938463463374607431768211455"};
+	for (int i(0); i < 5; i++)
+	{
+		BigInt(edges[i]).ToWords(words);
+		test(BigInt::FromWords(words), edges[i]);
+	}
+	
+	//compare with dividing by 2^32 over and over
+	const BigInt base("4294967296");
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		const BigInt a(randomBigInt(myRand(i % 4 ? 300 : 5000) + 1));
+		a.ToWords(words);
+		test(BigInt::FromWords(words), a);
+		BigInt rest(a);
+		bool same(true);
+		for (unsigned long int j(0); j < words.size(); j++)
+		{
+			same = same && rest % base == BigInt(words[j]);
+			rest = rest / base;
+		}
+		test(same && rest.EqualsZero(), true);
+	}
+	
+	//bytes in both orders, padded to a fixed width
+	const std::uint8_t bytes[] = {0x01, 0x00, 0x02, 0x03, 0x04, 0xFF};
+	test(BigInt::FromBytes(bytes, 6), "1099545380095");
+	test(BigInt::FromBytes(bytes, 6, BigInt::LITTLE), "280392695414785");
+	test(BigInt::FromBytes(bytes, 0), BigIntZero);
+	std::uint8_t out[8];
+	BigInt("1099545380095").ToBytes(out, 8);
+	test(out[0] == 0 && out[1] == 0 && std::equal(bytes, bytes + 6, out + 2), 
+			true);
+	BigInt("1099545380095").ToBytes(out, 8, BigInt::LITTLE);
+	test(out[0] == 0xFF && out[5] == 0x01 && out[6] == 0 && out[7] == 0, true);
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		const BigInt a(randomBigInt(myRand(100) + 1));
+		std::uint8_t buffer[64];
+		a.ToBytes(buffer, 64, i % 2 ? BigInt::BIG : BigInt::LITTLE);
+		test(BigInt::FromBytes(buffer, 64, 
+				i % 2 ? BigInt::BIG : BigInt::LITTLE), a);
+	}
+	thrown = false;
+	try
+	{
+		BigInt("65536").ToBytes(out, 2);
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	
+	//parsing and printing
+	const std::string digits(randomBigInt(1001).ToString());
+	test(BigInt(digits).ToString(), digits);
+	test(BigInt("-" + digits).ToString(), "-" + digits);
+	thrown = false;
+	try
+	{
+		BigInt("1234567890123456x890");
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	cout << "\nRadix conversion test finished!" << endl;
+}
+
+/*				WORD ARITHMETIC TEST					*/
+void WordArithmeticTest(unsigned long int testCount)
+{
+	cout << "\n\n\tWORD ARITHMETIC TEST\n\n";
+	
+	const unsigned long int words[] = {0, 1, 2, 9, 10, 65537, 
+			ULONG_MAX / 10, ULONG_MAX / 10 + 1, ULONG_MAX};
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		//small, big, negative and zero numbers, compared with the results 
+		//for two BigInt operands
+		BigInt a(randomBigInt(myRand(i % 2 ? 60 : 15) + 1));
+		if (i % 3 == 0)
+			a = -a;
+		if (i % 7 == 0)
+			a = BigIntZero;
+		for (int j(0); j < 9; j++)
+		{
+			const unsigned long int w(words[j]);
+			const BigInt b(w);
+			test(a + w, a + b);
+			test(w + a, a + b);
+			test(a - w, a - b);
+			test(w - a, b - a);
+			test(a * w, a * b);
+			test(w * a, a * b);
+			test((a < w) == (a < b) && (w < a) == (b < a) && 
+				(a <= w) == (a <= b) && (w >= a) == (b >= a) && 
+				(a > w) == (a > b) && (a == w) == (a == b) && 
+				(w != a) == (b != a), true);
+			if (w == 0)
+				continue;
+			test(a / w, a / b);
+			test(a % w, a % b);
+			BigInt quotient(a);
+			test(BigInt(quotient.DivideBy(w)), a.Abs() % b);
+			test(quotient, a / b);
+		}
+	}
+	
+	BigInt c("-1");
+	c += 5UL;
+	test(c, 4UL);
+	c -= 10UL;
+	test(c, "-6");
+	c++;
+	--c;
+	test(c, "-6");
+	test(BigInt("999999999999999999999") + 1UL, "1000000000000000000000");
+	test(BigInt("1000000000000000000000") - 1UL, "999999999999999999999");
+	bool thrown(false);
+	try
+	{
+		c.DivideBy(0);
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	cout << "\nWord arithmetic test finished!" << endl;
+}
+
+/*				EXACT DIVISION TEST						*/
+void ExactDivisionTest(unsigned long int testCount)
+{
+	cout << "\n\n\tEXACT DIVISION TEST\n\n";
+	
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		//divisors with factors of 2, 5 and 10, and negative numbers
+		BigInt d(randomBigInt(myRand(40) + 1));
+		if (i % 2 == 0)
+			d *= BigInt(2UL).GetPower(myRand(70));
+		if (i % 3 == 0)
+			d *= BigInt(5UL).GetPower(myRand(30));
+		if (i % 5 == 0)
+			d *= 1000UL;
+		BigInt q(randomBigInt(myRand(60) + 1));
+		if (i % 4 == 0)
+			q = -q;
+		test((q * d).DivExact(d), q);
+		test((q * d).DivExact(-d), -q);
+		test(d.DivExact(d), BigIntOne);
+	}
+	test(BigIntZero.DivExact(7UL), BigIntZero);
+	test(BigInt("1000000000000000000").DivExact(5UL), "200000000000000000");
+	cout << "\nExact division test finished!" << endl;
+}
+
+/*				LONG DIVISION TEST						*/
+void LongDivisionTest(unsigned long int testCount)
+{
+	cout << "\n\n\tLONG DIVISION TEST\n\n";
+	
+	//a nine digit limb of all nines makes the quotient limb guesses too big
+	const BigInt nines(std::string(2000, '9'));
+	test(nines / BigInt(std::string(1000, '9')), 
+			BigInt("1" + std::string(999, '0') + "1"));
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		//divisors on both sides of the Newton's method threshold, with 
+		//quotients shorter and longer than the divisor
+		const unsigned long int length(i % 2 ? myRand(200) + 2 : 
+				myRand(6000) + 9000);
+		const BigInt d(randomBigInt(length));
+		const BigInt q(randomBigInt(myRand(i % 3 ? length : 3 * length) + 1));
+		const BigInt r(randomBigInt(myRand(length - 1) + 1));
+		const BigInt a(q * d + r);
+		test(a / d, q);
+		test(a % d, r);
+		test((-a) / d, -q);
+		test((-a) % (-d), -r);
+		test((a - r) % d, BigIntZero);
+	}
+	cout << "\nLong division test finished!" << endl;
+}
+
+/*				BIT OPERATIONS TEST						*/
+void BitOperationsTest(unsigned long int testCount)
+{
+	cout << "\n\n\tBIT OPERATIONS TEST\n\n";
+	
+	const BigInt x(0xF0F0UL), y(0x3C3CUL);
+	test(x & y, 0x3030UL);
+	test(x | y, 0xFCFCUL);
+	test(x ^ y, 0xCCCCUL);
+	test(x << 4, 0xF0F00UL);
+	test(x >> 5, 0x787UL);
+	test(BigInt("-100") >> 3, "-12");
+	test(BigInt("-3") << 2, "-12");
+	test(BigIntOne >> 1, BigIntZero);
+	test(x.BitLength(), 16UL);
+	test(BigIntZero.BitLength(), 0UL);
+	test(x.TestBit(4) && !x.TestBit(3) && !x.TestBit(100), true);
+	test(x.TrailingZeros(), 4UL);
+	BigInt z(x);
+	z.SetBit(0);
+	z.SetBit(4);
+	test(z, 0xF0F1UL);
+	test(BigInt("-2").GetPower(BigInt(3UL)), "-8");
+	
+	const BigInt power(BigInt(2UL).GetPower(200UL));
+	test(power.TrailingZeros(), 200UL);
+	test(power.BitLength(), 201UL);
+	test(power.TestBit(200) && !power.TestBit(199), true);
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		const BigInt a(randomBigInt(myRand(200) + 1));
+		const BigInt b(randomBigInt(myRand(200) + 1));
+		const unsigned long int k(myRand(150));
+		const BigInt shifted(a * BigInt(2UL).GetPower(k));
+		test(a << k, shifted);
+		test(shifted >> k, a);
+		test(a >> k, a / BigInt(2UL).GetPower(k));
+		test(shifted.TrailingZeros(), a.TrailingZeros() + k);
+		test(shifted.TestBit(k + a.TrailingZeros()), true);
+		test((a & b) + (a | b), a + b);
+		test((a ^ b) ^ b, a);
+		test(a.BitLength() == shifted.BitLength() - k, true);
+	}
+	cout << "\nBit operations test finished!" << endl;
+}
+
+/*				SHORT PRODUCT TEST						*/
+void ShortProductTest(unsigned long int testCount)
+{
+	cout << "\n\n\tSHORT PRODUCT TEST\n\n";
+	
+	const BigInt a("123456789123456789"), b("987654321");
+	//a * b = 121932631234567900112635269
+	test(BigInt::MulLow(a, b, 10), "112635269");
+	test(BigInt::MulLow(a, b, 0), BigIntZero);
+	test(BigInt::MulLow(-a, b, 100), a * b);
+	test(BigInt::MulHigh(a, b, 0), a * b);
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		//long operands take the Karatsuba path of MulLow() and MulHigh()
+		const unsigned long int length(i % 4 ? myRand(300) + 1 : 
+				myRand(1000) + 1800);
+		const BigInt x(randomBigInt(length));
+		const BigInt y(randomBigInt(myRand(length) + 1));
+		const unsigned long int k(myRand(x.Length() + y.Length() + 2));
+		const BigInt power(BigInt(10UL).GetPower(k));
+		const BigInt product(x * y);
+		test(BigInt::MulLow(x, y, k), product % power);
+		const BigInt high(BigInt::MulHigh(x, y, k));
+		test(high == product / power || high + 1UL == product / power, true);
+	}
+	cout << "\nShort product test finished!" << endl;
+}
+
+/*				LARGE PRODUCT TEST						*/
+void LargeProductTest(unsigned long int testCount)
+{
+	cout << "\n\n\tLARGE PRODUCT TEST\n\n";
+	
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		//long enough for the partial products to be spread over threads
+		const BigInt x(randomBigInt(myRand(20000) + 30000));
+		const BigInt y(randomBigInt(myRand(20000) + 30000));
+		const BigInt product(BigInt::MulHigh(x, y, 0));
+		test(product / y, x);
+		test(product % x, BigIntZero);
+		//the high product of long operands is exact or one less
+		const unsigned long int k(myRand(product.Length() - 1) + 1);
+		const BigInt high(BigInt::MulHigh(x, y, k).ToString() + 
+				std::string(k, '0'));
+		const BigInt rest(product - high - BigInt::MulLow(x, y, k));
+		test(rest == BigIntZero || rest == "1" + std::string(k, '0'), true);
+	}
+	cout << "\nLarge product test finished!" << endl;
+}
+
+/*				BARRETT REDUCTION TEST					*/
+void BarrettReductionTest(unsigned long int testCount)
+{
+	cout << "\n\n\tBARRETT REDUCTION TEST\n\n";
+	cout << "Preparing to do " << testCount << " tests." << endl << endl;
+	
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		cout << "Test " << i << endl;
+		const BigInt n(randomBigInt(myRand(40) + 1));
+		const BarrettContext context(n);
+		cout << "n = " << n << endl;
+		
+		//numbers up to and a bit over 2k digits, and multiples of n
+		const BigInt a(randomBigInt(myRand(2 * n.Length() + 3) + 1));
+		BigInt reduced(a);
+		context.Reduce(reduced);
+		test(reduced, a % n);
+		reduced = -a;
+		context.Reduce(reduced);
+		test(reduced, a % n);
+		reduced = a * n;
+		context.Reduce(reduced);
+		test(reduced, BigIntZero);
+		reduced = n * n - BigIntOne;
+		context.Reduce(reduced);
+		test(reduced, n - BigIntOne);
+		
+		const BigInt b(randomBigInt(myRand(n.Length()) + 1));
+		test(context.Multiply(a, b), a * b % n);
+		BigInt power(BigIntOne);
+		for (int j(0); j < 7; j++)
+			power = power * b % n;
+		test(context.PowerMod(b, 7), power);
+		
+		//a product of 2 to 8 powers
+		std::vector<BigInt> bases, exponents;
+		BigInt product(BigIntOne);
+		for (unsigned long int j(myRand(7) + 2); j > 0; j--)
+		{
+			bases.push_back(randomBigInt(myRand(2 * n.Length()) + 1));
+			exponents.push_back(j == 1 ? BigIntZero : 
+					randomBigInt(myRand(60) + 1));
+			product = product * bases.back().GetPowerMod(exponents.back(), n)
+					% n;
+		}
+		test(BigInt::MultiPowMod(bases, exponents, n), product);
+	}
+	cout << "\nBarrett reduction test finished!" << endl;
+}
+
+/*				RESIDUE TEST							*/
+void TestResidue()
+{
+	cout << "\n\n\tRESIDUE TEST\n\n";
+	
+	const std::shared_ptr<const BarrettContext> context(
+			std::make_shared<const BarrettContext>(97));
+	const Residue a(context, 50), b(context, 60), c(context, 7);
+	test((a + b).GetValue(), 13);
+	test((a - b).GetValue(), 87);
+	test(Residue(context, "-5").GetValue(), 92);
+	test(Residue(context, "1000").GetValue(), 30);
+	test((c * Residue(context, 14)).GetValue(), BigIntOne);
+	test(c.Inverse().GetValue(), 14);
+	test(c.Power(96).GetValue(), BigIntOne);
+	test(c.Power(BigIntZero).GetValue(), BigIntOne);
+	test(a * a.Inverse() == Residue(context, BigIntOne), true);
+	//a residue made with another context for the same modulus
+	test(a == Residue(50, 97), true);
+	
+	//errors
+	bool thrown(false);
+	try
+	{
+		Residue(6, 12).Inverse();
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	thrown = false;
+	try
+	{
+		a + Residue(50, 98);
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	
+	//a big modulus
+	const BigInt n("170141183460469231731687303715884105727");	//2^127 - 1
+	const Residue x("123456789012345678901234567890", n);
+	test(x.Inverse().Inverse() == x, true);
+	test((x * x.Inverse()).GetValue(), BigIntOne);
+	test(x.Power(n - BigIntOne).GetValue(), BigIntOne);
+	
+	cout << "\nResidue test finished!" << endl;
+}
+
+/*				FIXED BASE TEST							*/
+void FixedBaseTest(unsigned long int testCount)
+{
+	cout << "\n\n\tFIXED BASE TEST\n\n";
+	cout << "Preparing to do " << testCount << " tests." << endl << endl;
+	
+	for (unsigned long int i(1); i <= testCount; i++)
+	{
+		cout << "Test " << i << endl;
+		const BigInt n(randomBigInt(myRand(40) + 1));
+		const BigInt base(randomBigInt(myRand(2 * n.Length()) + 1));
+		//a small budget gives a comb with fewer rows
+		const FixedBase fixed(base, n, 100, myRand(2) ? 1UL << 16 : 1);
+		cout << "n = " << n << ", rows = " << fixed.GetRowCount() << endl;
+		
+		for (int j(0); j < 3; j++)
+		{
+			const BigInt exponent(randomBigInt(myRand(30) + 1));
+			test(fixed.PowerMod(exponent), base.GetPowerMod(exponent, n));
+		}
+		test(fixed.PowerMod(BigIntZero), base.GetPowerMod(BigIntZero, n));
+		//exponents longer than the comb
+		const BigInt exponent(randomBigInt(40));
+		test(fixed.PowerMod(exponent), base.GetPowerMod(exponent, n));
+	}
+	
+	const BigInt n("170141183460469231731687303715884105727");	//2^127 - 1
+	const FixedBase fixed(3, n, 127);
+	test(fixed.PowerMod(n - BigIntOne), BigIntOne);
+	test(fixed.PowerMod(n), 3);
+	cout << "\nFixed base test finished!" << endl;
+}
+
 /*				PRIME GENERATOR TEST					*/
 void TestPrimeGenerator(unsigned long int testCount, 
 						unsigned long int digitCount, 
@@ -949,6 +1447,15 @@ void TestEncryptionDecryption(	unsigned long int testCount,
 												newKeyPair.GetPrivateKey());
 		cout << "done!\n" << endl;
 		test(message, newMessage);
+		
+		//the other formats, recognized by Decrypt()
+		for (int format = RSA::BINARY; format <= RSA::HYBRID; format++)
+		{
+			cypherText = RSA::Encrypt(	message, newKeyPair.GetPublicKey(), 
+										RSA::Format(format));
+			test(RSA::Decrypt(cypherText, newKeyPair.GetPrivateKey()), 
+					message);
+		}
 	}
 	
 	cout << "\nEncryption/decryption test finished!" << endl;
@@ -979,7 +1486,403 @@ void TestFileEncryptionDecryption(	unsigned long int testCount,
 		cout << "done!\n" << endl;
 		test(system("diff test/message.txt "
 				"test/new_message.txt"), 0);
+		
+		cout << "Encrypting the file as text... ";
+		RSA::Encrypt(	messageFile, cypherFile, newKeyPair.GetPublicKey(), 
+						RSA::TEXT);
+		cout << "done!\nDecrypting the file... ";
+		RSA::Decrypt(cypherFile, destFile, newKeyPair.GetPrivateKey());
+		cout << "done!\n" << endl;
+		test(system("diff test/message.txt "
+				"test/new_message.txt"), 0);
+		
+		cout << "Encrypting the file using a session key... ";
+		RSA::Encrypt(	messageFile, cypherFile, newKeyPair.GetPublicKey(), 
+						RSA::HYBRID);
+		cout << "done!\nDecrypting the file... ";
+		RSA::Decrypt(cypherFile, destFile, newKeyPair.GetPrivateKey());
+		cout << "done!\n" << endl;
+		test(system("diff test/message.txt "
+				"test/new_message.txt"), 0);
 	}
 	
+#if defined(__linux__)
+	//a pipe isn't mapped, so it is read in portions; a TEXT chunk longer 
+	//than the modulus is rejected as soon as it is read, instead of 
+	//being buffered until a ' ' comes
+	char fifo[] = "test/digits.fifo";
+	unlink(fifo);
+	if (mkfifo(fifo, 0600) == 0)
+	{
+		//less than the pipe holds, so the writer never waits for reading
+		std::thread writer([&fifo]()
+		{
+			const std::string digits(20000, '1');
+			std::ofstream file(fifo, std::ios::binary);
+			file.write(digits.data(), digits.length());
+		});
+		std::string error;
+		try
+		{
+			RSA::Decrypt(fifo, destFile, newKeyPair.GetPrivateKey());
+		}
+		catch (const char *message)
+		{
+			error = message;
+		}
+		writer.join();
+		unlink(fifo);
+		test(error, std::string("Error RSA02: Chunk too large."));
+	}
+#endif
+	
 	cout << "\nFile encryption/decryption test finished!" << endl;
 }
+
+/*				PARALLEL ENCRYPTION/DECRYPTION TEST		*/
+void TestParallelEncryptionDecryption(	unsigned long int testCount, 
+										unsigned long int keyLength)
+{
+	cout << "\n\n\tPARALLEL ENCRYPTION/DECRYPTION TEST\n\n";
+	cout << "Preparing to do " << testCount << " tests.\nKeylength: " 
+	<< keyLength << endl;
+	
+	KeyPair newKeyPair(RSA::GenerateKeyPair(keyLength));
+	cout << "\n" << newKeyPair << "\n\ndone!" << endl;
+	for (unsigned long int i = 1; i <= testCount; i++)
+	{
+		std::string message;
+		for (unsigned long int j = 0; j < 200; j++)
+			message.push_back(char(myRand(256)));
+		
+		cout << i << ".\nEncrypting the message serially... ";
+		RSA::SetParallelThreshold(0);
+		std::string serialText = RSA::Encrypt(	message, 
+												newKeyPair.GetPublicKey());
+		cout << "done!\nEncrypting the message in parallel... ";
+		RSA::SetParallelThreshold(1);
+		std::string cypherText = RSA::Encrypt(	message, 
+												newKeyPair.GetPublicKey());
+		cout << "done!\nDecrypting the message in parallel... ";
+		std::string newMessage = RSA::Decrypt(	cypherText, 
+												newKeyPair.GetPrivateKey());
+		cout << "done!\n" << endl;
+		test(cypherText, serialText);
+		test(message, newMessage);
+	}
+	RSA::SetParallelThreshold(4);
+	
+	cout << "\nParallel encryption/decryption test finished!" << endl;
+}
+
+/*				CHACHA20 TEST							*/
+void TestChaCha20()
+{
+	cout << "\n\n\tCHACHA20 TEST\n\n";
+	
+	//the test vector from RFC 8439, section 2.4.2
+	unsigned char key[ChaCha20::KeySize];
+	for (unsigned long int i = 0; i < ChaCha20::KeySize; i++)
+		key[i] = static_cast<unsigned char>(i);
+	const unsigned char nonce[ChaCha20::NonceSize] = 
+			{0, 0, 0, 0, 0, 0, 0, 0x4a, 0, 0, 0, 0};
+	const char message[] = "Ladies and Gentlemen of the class of '99: If I "
+			"could offer you only one tip for the future, sunscreen would "
+			"be it.";
+	const unsigned char expected[] = {
+			0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 
+			0x41, 0xba, 0x07, 0x28, 0xdd, 0x0d, 0x69, 0x81, 
+			0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2, 
+			0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b, 
+			0xf9, 0x1b, 0x65, 0xc5, 0x52, 0x47, 0x33, 0xab, 
+			0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57, 
+			0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 
+			0x8f, 0x53, 0x0c, 0x35, 0x9f, 0x08, 0x61, 0xd8, 
+			0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61, 
+			0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e, 
+			0x52, 0xbc, 0x51, 0x4d, 0x16, 0xcc, 0xf8, 0x06, 
+			0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36, 
+			0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 
+			0xb4, 0x0b, 0x8e, 0xed, 0xf2, 0x78, 0x5e, 0x42, 
+			0x87, 0x4d};
+	const unsigned long int length(std::strlen(message));
+	test(length, static_cast<unsigned long int>(sizeof expected));
+	
+	//the test vector starts with the block counter 1
+	ChaCha20 cipher(key, nonce);
+	cipher.Seek(64);
+	std::string cypherText(length, '\0');
+	cipher.Process(message, &cypherText[0], length);
+	test(cypherText, std::string(expected, expected + length));
+	
+	//processing in pieces, starting in the middle of a block
+	ChaCha20 pieces(key, nonce);
+	pieces.Seek(64 + 5);
+	std::string piecesText(message, message + 5);
+	piecesText.resize(length);
+	pieces.Process(message + 5, &piecesText[5], 70);
+	pieces.Process(message + 75, &piecesText[75], length - 75);
+	test(piecesText.substr(5), cypherText.substr(5));
+	
+	//decryption
+	ChaCha20 decipher(key, nonce);
+	decipher.Seek(64);
+	decipher.Process(&cypherText[0], &cypherText[0], length);
+	test(cypherText, std::string(message));
+	
+	//the end of the key stream can be used, but not past it
+	ChaCha20 last(key, nonce);
+	last.Seek(ChaCha20::StreamSize - 70);
+	char bytes[70];
+	last.Process(message, bytes, 70);
+	bool thrown(false);
+	try
+	{
+		last.Process(message, bytes, 1);
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	thrown = false;
+	try
+	{
+		last.Seek(ChaCha20::StreamSize);
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	//seeking back starts the key stream over
+	last.Seek(64);
+	last.Process(message, bytes, 70);
+	test(std::string(bytes, bytes + 70), 
+			std::string(expected, expected + 70));
+	
+	cout << "\nChaCha20 test finished!" << endl;
+}
+
+/*				SIGNATURE TEST							*/
+void TestSignature(	unsigned long int testCount, 
+					unsigned long int keyLength)
+{
+	cout << "\n\n\tSIGNATURE TEST\n\n";
+	
+	//test vectors from FIPS 180-4
+	const char abc[] = "abc";
+	const unsigned char abcDigest[] = {
+			0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 
+			0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23, 
+			0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 
+			0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+	test(	SHA256::Hash(abc, 3), 
+			std::string(abcDigest, abcDigest + sizeof abcDigest));
+	//a million times 'a', given in uneven pieces
+	const unsigned char millionDigest[] = {
+			0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 
+			0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 
+			0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 
+			0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0};
+	SHA256 sha256;
+	const std::string a(1001, 'a');
+	for (unsigned long int i = 0; i < 1000; i++)
+		sha256.Update(a.data(), i % 2 ? 999 : 1001);
+	test(	sha256.Finish(), 
+			std::string(millionDigest, millionDigest + sizeof millionDigest));
+	
+	cout << "\nPreparing to do " << testCount << " tests.\nKeylength: " 
+	<< keyLength << endl;
+	KeyPair newKeyPair(RSA::GenerateKeyPair(keyLength));
+	cout << "\n" << newKeyPair << "\n\ndone!" << endl;
+	const Key &privateKey(newKeyPair.GetPrivateKey());
+	const Key &publicKey(newKeyPair.GetPublicKey());
+	for (unsigned long int i = 1; i <= testCount; i++)
+	{
+		std::string message;
+		for (unsigned long int j = 0; j < 100; j++)
+			message.push_back(char(myRand(256)));
+		
+		cout << i << ".\nSigning the message... ";
+		BigInt signature(RSA::Sign(message, privateKey));
+		cout << "done!\nVerifying the signature... ";
+		test(RSA::Verify(message, signature, publicKey), true);
+		cout << "done!\n" << endl;
+		
+		//the same signature without the Chinese Remainder Theorem
+		const Key plainKey(privateKey.GetModulus(), privateKey.GetExponent());
+		test(RSA::Sign(message, plainKey), signature);
+		
+		//a different message or signature doesn't verify
+		message[0]++;
+		test(RSA::Verify(message, signature, publicKey), false);
+		message[0]--;
+		test(RSA::Verify(message, signature + BigIntOne, publicKey), false);
+		
+		BigInt fileSignature(RSA::SignFile("test/message.txt", privateKey));
+		test(RSA::VerifyFile("test/message.txt", fileSignature, publicKey), 
+				true);
+		
+		//a batch with valid and invalid signatures
+		std::vector<std::pair<std::string, BigInt> > batch;
+		for (unsigned long int j = 0; j < 8; j++)
+		{
+			message[0] = char(j);
+			batch.push_back(std::make_pair(
+					SHA256::Hash(message.data(), message.length()), 
+					RSA::Sign(message, privateKey)));
+		}
+		batch[2].second += BigIntOne;
+		batch[5].first[0]++;
+		batch[6].second = privateKey.GetModulus();
+		batch[7].first.resize(3);
+		RSA::SetParallelThreshold(1);
+		std::vector<bool> results(RSA::VerifyBatch(batch, publicKey));
+		RSA::SetParallelThreshold(4);
+		test(results.size(), static_cast<std::size_t>(8));
+		for (unsigned long int j = 0; j < results.size(); j++)
+			test(bool(results[j]), j != 2 && j < 5);
+	}
+	
+	//keys too short for the padding are rejected
+	bool thrown(false);
+	try
+	{
+		RSA::Sign("abc", Key(BigInt("1000000000000000000000000000000000"
+				"000000000000000000000000000000000000000000000000000000000"
+				"000000000000000000000000000000000000000000000000001"), 
+				BigIntOne));
+	}
+	catch (const char *)
+	{
+		thrown = true;
+	}
+	test(thrown, true);
+	
+	cout << "\nSignature test finished!" << endl;
+}
+
+/*				STREAM ENCRYPTION/DECRYPTION TEST		*/
+void TestStreamEncryptionDecryption(unsigned long int testCount, 
+									unsigned long int keyLength)
+{
+	cout << "\n\n\tSTREAM ENCRYPTION/DECRYPTION TEST\n\n";
+	cout << "Preparing to do " << testCount << " tests.\nKeylength: " 
+	<< keyLength << endl;
+	
+	KeyPair newKeyPair(RSA::GenerateKeyPair(keyLength));
+	cout << "\n" << newKeyPair << "\n\ndone!" << endl;
+	for (unsigned long int i = 1; i <= testCount; i++)
+	{
+		//long enough to fill the buffer of the encryptor
+		std::string message;
+		for (unsigned long int j = 0; j < 5000; j++)
+			message.push_back(char(myRand(256)));
+		
+		for (int format = RSA::TEXT; format <= RSA::HYBRID; format++)
+		{
+			cout << i << ".\nEncrypting the message in pieces... ";
+			RSA::Encryptor encryptor(	newKeyPair.GetPublicKey(), 
+										RSA::Format(format));
+			std::string cypherText;
+			for (unsigned long int j = 0, size; j < message.length(); 
+				j += size)
+			{
+				size = myRand(100) + 1;
+				if (size > message.length() - j)
+					size = message.length() - j;
+				cypherText.append(encryptor.Update(&message[j], size));
+			}
+			cypherText.append(encryptor.Finish());
+			cout << "done!\nDecrypting the message in pieces... ";
+			RSA::Decryptor decryptor(newKeyPair.GetPrivateKey());
+			std::string newMessage;
+			for (unsigned long int j = 0, size; j < cypherText.length(); 
+				j += size)
+			{
+				size = myRand(100) + 1;
+				if (size > cypherText.length() - j)
+					size = cypherText.length() - j;
+				newMessage.append(decryptor.Update(&cypherText[j], size));
+			}
+			newMessage.append(decryptor.Finish());
+			cout << "done!\n" << endl;
+			test(message, newMessage);
+			
+			//a cut off cyphertext is rejected; a HYBRID one only if the 
+			//header is cut, since the stream cipher has no chunks
+			RSA::Decryptor cutDecryptor(newKeyPair.GetPrivateKey());
+			cutDecryptor.Update(cypherText.data(), format == RSA::HYBRID ? 
+					5 : cypherText.length() - 1);
+			bool rejected(false);
+			try
+			{
+				cutDecryptor.Finish();
+			}
+			catch (const char *)
+			{
+				rejected = true;
+			}
+			test(rejected, true);
+		}
+		
+		//a TEXT chunk longer than the modulus is rejected before its end
+		RSA::Decryptor longDecryptor(newKeyPair.GetPrivateKey());
+		const std::string digits(
+				newKeyPair.GetPrivateKey().GetModulus().Length() + 1, '1');
+		bool rejected(false);
+		try
+		{
+			longDecryptor.Update(digits.data(), digits.length());
+		}
+		catch (const char *)
+		{
+			rejected = true;
+		}
+		test(rejected, true);
+	}
+	
+	cout << "\nStream encryption/decryption test finished!" << endl;
+}
+
+/*				KEY POOL TEST							*/
+void TestKeyPool(	unsigned long int testCount, 
+					unsigned long int keyLength)
+{
+	cout << "\n\n\tKEY POOL TEST\n\n";
+	cout << "Preparing to do " << testCount << " tests.\nKeylength: " 
+	<< keyLength << endl << endl;
+	
+	KeyPool pool(2, 2);
+	pool.Reserve(keyLength);
+	for (unsigned long int i = 1; i <= testCount; i++)
+	{
+		cout << i << ". " << endl;
+		KeyPair newKeyPair(pool.Acquire(keyLength, 60000));
+		std::string message("aha");
+		std::string cypherText = RSA::Encrypt(	message, 
+												newKeyPair.GetPublicKey());
+		std::string newMessage = RSA::Decrypt(	cypherText, 
+												newKeyPair.GetPrivateKey());
+		cout << newKeyPair << endl;
+		test(message, newMessage);
+		
+		//wait for the pool to refill, then take a key without blocking
+		while (pool.GetDepth(keyLength) == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		test(pool.TryAcquire(keyLength, newKeyPair), true);
+		cout << "Generated: " << pool.GetGeneratedCount() << ", rate: " 
+				<< pool.GetRefillRate() << " keys/s" << endl;
+		test(pool.GetGeneratedCount() >= 2 * i, true);
+	}
+	
+	//once full, the pool has generated one keypair per keypair taken 
+	//and no more, even with two threads refilling it
+	while (pool.GetDepth(keyLength) < 2)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	test(pool.GetDepth(keyLength), 2UL);
+	test(pool.GetGeneratedCount(), 2 * testCount + 2);
+	
+	cout << "\nKey pool test finished!" << endl;
+}
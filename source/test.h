@@ -42,6 +42,26 @@ void FactorialBenchmark();
 void RandomBigIntTest(unsigned long int testCount);
 /*				RANDOM DIVISION TEST GENERATOR			*/
 void RandomBigIntDivisionTest(unsigned long int testCount);
+/*				RADIX CONVERSION TEST					*/
+void RadixConversionTest(unsigned long int testCount);
+/*				WORD ARITHMETIC TEST					*/
+void WordArithmeticTest(unsigned long int testCount);
+/*				EXACT DIVISION TEST						*/
+void ExactDivisionTest(unsigned long int testCount);
+/*				LONG DIVISION TEST						*/
+void LongDivisionTest(unsigned long int testCount);
+/*				BIT OPERATIONS TEST						*/
+void BitOperationsTest(unsigned long int testCount);
+/*				SHORT PRODUCT TEST						*/
+void ShortProductTest(unsigned long int testCount);
+/*				LARGE PRODUCT TEST						*/
+void LargeProductTest(unsigned long int testCount);
+/*				BARRETT REDUCTION TEST					*/
+void BarrettReductionTest(unsigned long int testCount);
+/*				RESIDUE TEST							*/
+void TestResidue();
+/*				FIXED BASE TEST							*/
+void FixedBaseTest(unsigned long int testCount);
 /*				PRIME GENERATOR TEST					*/
 void TestPrimeGenerator(unsigned long int testCount, 
 						unsigned long int digitCount = 10, 
@@ -55,5 +75,19 @@ void TestEncryptionDecryption(	unsigned long int testCount,
 /*				FILE ENCRYPTION/DECRYPTION TEST			*/
 void TestFileEncryptionDecryption(	unsigned long int testCount, 
 									unsigned long int keyLength = 12);
+/*				PARALLEL ENCRYPTION/DECRYPTION TEST		*/
+void TestParallelEncryptionDecryption(	unsigned long int testCount, 
+										unsigned long int keyLength = 20);
+/*				CHACHA20 TEST							*/
+void TestChaCha20();
+/*				SIGNATURE TEST							*/
+void TestSignature(	unsigned long int testCount, 
+					unsigned long int keyLength = 8);
+/*				STREAM ENCRYPTION/DECRYPTION TEST		*/
+void TestStreamEncryptionDecryption(unsigned long int testCount, 
+									unsigned long int keyLength = 8);
+/*				KEY POOL TEST							*/
+void TestKeyPool(	unsigned long int testCount, 
+					unsigned long int keyLength = 8);
 
 #endif /*TEST_H_*/